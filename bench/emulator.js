@@ -0,0 +1,205 @@
+/*
+ * Watch-side benchmark in the SDK emulator.
+ *
+ * Builds the app with benchmark probes (BENCH=1 pebble build), then for
+ * each platform boots the emulator headless (VNC display), installs the
+ * .pbw and follows `pebble logs`. PebbleKit JS runs the real phone-side
+ * scripts against the synthetic servers in bench/fake_dexcom.js, so the
+ * watch receives a full day of readings exactly as it would from a phone.
+ * Once the first chart is up, the script pans back through history and
+ * returns to the live view to drive more frames.
+ *
+ * Collected from the watch's "BENCH {json}" log lines (src/c/bench.h):
+ *   firstChartMs - launch to the first chart frame with readings
+ *   drawnMs      - chart_layer_update_proc time for frames drawn
+ *   restoredMs   - ...for frames restored from the render memo
+ *   blittedMs    - ...for frames blitted from the phone-rendered bitmap
+ *   chartMs      - ...for every new chart, drawn or blitted
+ *   inboxMs      - inbox handler time per message (decoding included)
+ *   inboxBytes   - bytes received over the run
+ *   heapPeak     - heap high-water mark (bytes)
+ *   heapSize     - app heap size on the platform (bytes)
+ *
+ * With --render phone the build sets the phone-rendered chart for every
+ * platform (BENCH_RENDER=phone), so the watch blits the live chart
+ * instead of drawing it.
+ *
+ * Usage: node bench/emulator.js [--platforms aplite,basalt,...]
+ *            [--render native|phone] [--out FILE] [--compare BASE.json]
+ *            [--no-build] [--timeout SECONDS]
+ * The report (default build/bench-emulator.json) records the commit and
+ * render mode, so reports from two commits or two modes can be compared
+ * with --compare.
+ */
+'use strict';
+
+var childProcess = require('child_process');
+var fs = require('fs');
+var path = require('path');
+
+var ROOT = path.join(__dirname, '..');
+var PLATFORMS = ['aplite', 'basalt', 'diorite', 'emery'];
+var PANS = 8;               /* Up presses before returning to live */
+var PAN_INTERVAL_MS = 400;  /* Between button presses */
+var SETTLE_MS = 2000;       /* After the last press, for trailing frames */
+
+function option(argv, name, fallback) {
+    var i = argv.indexOf(name);
+    return i >= 0 && i + 1 < argv.length ? argv[i + 1] : fallback;
+}
+
+function pebble(args, options) {
+    return childProcess.spawnSync('pebble', args, Object.assign({ cwd: ROOT, encoding: 'utf8' }, options));
+}
+
+function stats(values) {
+    if (values.length === 0) return null;
+    var sorted = values.slice().sort(function(a, b) { return a - b; });
+    var pick = function(q) { return sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))]; };
+    return { count: sorted.length, median: pick(0.5), p90: pick(0.9), max: sorted[sorted.length - 1] };
+}
+
+function findPbw() {
+    var dir = path.join(ROOT, 'build');
+    var files = fs.existsSync(dir) ? fs.readdirSync(dir).filter(function(f) { return /\.pbw$/.test(f); }) : [];
+    if (files.length === 0) throw new Error('No .pbw in build/; run without --no-build');
+    return path.join(dir, files[0]);
+}
+
+function sleep(ms) {
+    return new Promise(function(resolve) { setTimeout(resolve, ms); });
+}
+
+/**
+ * Run one platform: install with logs, wait for the first chart, pan,
+ * and summarize the BENCH events
+ */
+function runPlatform(platform, pbw, timeoutSec) {
+    pebble(['kill']);
+    var events = [];
+    var child = childProcess.spawn('pebble', ['install', '--emulator', platform, '--vnc', '--logs', pbw], {
+        cwd: ROOT
+    });
+    var buffered = '';
+    var firstChart = null;
+    var onFirstChart;
+    var firstChartSeen = new Promise(function(resolve) { onFirstChart = resolve; });
+
+    child.stdout.on('data', function(chunk) {
+        buffered += chunk;
+        var lines = buffered.split('\n');
+        buffered = lines.pop();
+        lines.forEach(function(line) {
+            var m = line.match(/BENCH (\{.*\})/);
+            if (!m) return;
+            try {
+                var event = JSON.parse(m[1]);
+                events.push(event);
+                if (event.event === 'first_chart' && !firstChart) {
+                    firstChart = event;
+                    onFirstChart();
+                }
+            } catch (e) { /* Truncated log line */ }
+        });
+    });
+
+    var timedOut = sleep(timeoutSec * 1000).then(function() { return 'timeout'; });
+    return Promise.race([firstChartSeen, timedOut]).then(function(result) {
+        if (result === 'timeout') return;
+        var presses = [];
+        for (var i = 0; i < PANS; i++) presses.push('up');
+        presses.push('select');
+        return presses.reduce(function(done, button) {
+            return done.then(function() {
+                pebble(['emu-button', 'click', button, '--emulator', platform]);
+                return sleep(PAN_INTERVAL_MS);
+            });
+        }, Promise.resolve()).then(function() { return sleep(SETTLE_MS); });
+    }).then(function() {
+        child.kill();
+        pebble(['kill']);
+
+        var frames = events.filter(function(e) { return e.event === 'frame'; });
+        var inbox = events.filter(function(e) { return e.event === 'inbox'; });
+        var start = events.filter(function(e) { return e.event === 'start'; })[0];
+        var peak = frames.reduce(function(max, e) { return Math.max(max, e.heap_peak); }, start ? start.heap : 0);
+        var frameMs = function(kinds) {
+            return stats(frames.filter(function(e) { return kinds.indexOf(e.kind) >= 0; })
+                .map(function(e) { return e.render_ms; }));
+        };
+        return {
+            ok: !!firstChart,
+            firstChartMs: firstChart ? firstChart.ms : null,
+            drawnMs: frameMs(['drawn']),
+            restoredMs: frameMs(['restored']),
+            blittedMs: frameMs(['blitted']),
+            chartMs: frameMs(['drawn', 'blitted']),
+            inboxMs: stats(inbox.map(function(e) { return e.handle_ms; })),
+            inboxBytes: inbox.reduce(function(sum, e) { return sum + e.bytes; }, 0),
+            heapPeak: peak,
+            heapSize: start ? start.heap + start.heap_free : null
+        };
+    });
+}
+
+function delta(now, base) {
+    if (now === null || now === undefined || base === null || base === undefined) return 'n/a';
+    var d = now - base;
+    return (d >= 0 ? '+' : '') + d + (base ? ' (' + (d >= 0 ? '+' : '') + Math.round(100 * d / base) + '%)' : '');
+}
+
+function printComparison(report, base) {
+    Object.keys(report.platforms).forEach(function(p) {
+        var now = report.platforms[p];
+        var was = base.platforms[p];
+        if (!was) return;
+        var median = function(s) { return s && s.median; };
+        console.log(p + ' vs ' + base.commit.slice(0, 8) + ' (' + (base.render || 'native') + '):');
+        console.log('  first chart ms   ' + now.firstChartMs + '  ' + delta(now.firstChartMs, was.firstChartMs));
+        console.log('  drawn median ms  ' + median(now.drawnMs) + '  ' + delta(median(now.drawnMs), median(was.drawnMs)));
+        console.log('  chart median ms  ' + median(now.chartMs) + '  ' + delta(median(now.chartMs), median(was.chartMs)));
+        console.log('  inbox median ms  ' + median(now.inboxMs) + '  ' + delta(median(now.inboxMs), median(was.inboxMs)));
+        console.log('  inbox bytes      ' + now.inboxBytes + '  ' + delta(now.inboxBytes, was.inboxBytes));
+        console.log('  heap peak bytes  ' + now.heapPeak + '  ' + delta(now.heapPeak, was.heapPeak));
+    });
+}
+
+function main(argv) {
+    var platforms = option(argv, '--platforms', PLATFORMS.join(',')).split(',');
+    var out = option(argv, '--out', path.join(ROOT, 'build', 'bench-emulator.json'));
+    var compare = option(argv, '--compare', null);
+    var timeoutSec = parseInt(option(argv, '--timeout', '180'), 10);
+    var render = option(argv, '--render', 'native');
+
+    if (argv.indexOf('--no-build') < 0) {
+        var env = Object.assign({}, process.env, { BENCH: '1', BENCH_RENDER: render });
+        var build = pebble(['build'], { env: env, stdio: 'inherit' });
+        if (build.status !== 0) {
+            console.error('BENCH=1 pebble build failed');
+            process.exit(1);
+        }
+    }
+    var pbw = findPbw();
+    var commit = childProcess.spawnSync('git', ['rev-parse', 'HEAD'], { cwd: ROOT, encoding: 'utf8' }).stdout.trim();
+    var report = { commit: commit, render: render, date: new Date().toISOString(), platforms: {} };
+
+    platforms.reduce(function(done, platform) {
+        return done.then(function() {
+            console.log('Benchmarking ' + platform + '...');
+            return runPlatform(platform, pbw, timeoutSec).then(function(result) {
+                report.platforms[platform] = result;
+                if (!result.ok) console.error(platform + ': no chart within ' + timeoutSec + ' s');
+            });
+        });
+    }, Promise.resolve()).then(function() {
+        fs.writeFileSync(out, JSON.stringify(report, null, 2) + '\n');
+        console.log('Wrote ' + out);
+        if (compare) {
+            printComparison(report, JSON.parse(fs.readFileSync(compare, 'utf8')));
+        }
+        var failed = platforms.some(function(p) { return !report.platforms[p].ok; });
+        process.exit(failed ? 1 : 0);
+    });
+}
+
+main(process.argv.slice(2));
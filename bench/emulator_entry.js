@@ -0,0 +1,21 @@
+/*
+ * PebbleKit JS entry point for benchmark builds (BENCH=1 pebble build).
+ *
+ * Runs the real phone-side scripts inside the emulator's PebbleKit JS,
+ * with Dexcom and Nightscout answered by the synthetic servers in
+ * bench/fake_dexcom.js instead of the network.
+ */
+'use strict';
+
+var fakeDexcom = require('./fake_dexcom');
+
+window.XMLHttpRequest = fakeDexcom.createXhr({ intervalSec: 300 });
+/* Written every launch: the emulator keeps storage between runs, and the
+   render mode must not carry over from a run in the other mode */
+var phone = !!window.benchPhoneRender;
+window.localStorage.setItem('clay-settings', JSON.stringify({
+    DEX_LOGIN: 'bench', DEX_PASSWORD: 'bench', BG_UNITS: 'mg/dL',
+    PHONE_RENDER: [phone, phone, phone, phone, phone]
+}));
+
+require('../src/pkjs/index');
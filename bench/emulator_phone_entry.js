@@ -0,0 +1,9 @@
+/*
+ * PebbleKit JS entry point for phone-rendered benchmark builds
+ * (BENCH=1 BENCH_RENDER=phone pebble build): bench/emulator_entry.js with
+ * the phone drawing the chart on every platform.
+ */
+'use strict';
+
+window.benchPhoneRender = true;
+require('./emulator_entry');
@@ -0,0 +1,91 @@
+/*
+ * Fake Dexcom Share and Nightscout servers behind an XMLHttpRequest
+ * constructor.
+ *
+ * Shared by the Node fake (bench/fake_pebble.js) and the emulator
+ * benchmark's PebbleKit JS entry (bench/emulator_entry.js), so it uses
+ * nothing beyond ES5 and setTimeout.
+ */
+'use strict';
+
+var SYNTHETIC_ACCOUNT = '"11111111-1111-1111-1111-111111111111"';
+
+/**
+ * Synthetic glucose trace: a slow sine wave sampled every intervalSec
+ * @param {number} count - Number of readings, newest first
+ * @param {number} intervalSec - Sample spacing in seconds
+ */
+function syntheticReadings(count, intervalSec) {
+    var now = Date.now();
+    var out = [];
+    for (var i = 0; i < count; i++) {
+        out.push({
+            WT: 'Date(' + (now - i * intervalSec * 1000) + ')',
+            ST: '', DT: '',
+            Value: Math.round(140 + 60 * Math.sin(i / 9)),
+            Trend: 'Flat'
+        });
+    }
+    return out;
+}
+
+/**
+ * Synthetic Nightscout treatments: a meal bolus every 4 hours and a
+ * correction bolus two hours after each
+ * @param {number} sinceMs - Oldest treatment time (ms)
+ */
+function syntheticTreatments(sinceMs) {
+    var now = Date.now();
+    var out = [];
+    for (var t = now - 3600000; t >= sinceMs; t -= 4 * 3600000) {
+        out.push({ created_at: new Date(t).toISOString(), eventType: 'Meal Bolus', insulin: 4.5, carbs: 45 });
+        if (t - 2 * 3600000 >= sinceMs) {
+            out.push({ created_at: new Date(t - 2 * 3600000).toISOString(), eventType: 'Correction Bolus', insulin: 1.2 });
+        }
+    }
+    return out;
+}
+
+/**
+ * Build a fake XMLHttpRequest constructor
+ * @param {Object} options - latencyMs (fake network delay), intervalSec
+ *   (sample spacing), onRequest (called for each request sent)
+ * @returns {Function} XMLHttpRequest replacement
+ */
+function createXhr(options) {
+    options = options || {};
+    var latency = options.latencyMs || 0;
+    var intervalSec = options.intervalSec || 300;
+
+    return function() {
+        var req = this;
+        req.readyState = 0;
+        req.open = function(method, url) { req.url = url; };
+        req.setRequestHeader = function() {};
+        req.abort = function() {};
+        req.send = function(body) {
+            if (options.onRequest) options.onRequest(req);
+            setTimeout(function() {
+                req.readyState = 4;
+                req.status = 200;
+                if (/treatments/.test(req.url)) {
+                    var since = decodeURIComponent(req.url).match(/\$gte\]=([^&]+)/);
+                    req.responseText = JSON.stringify(syntheticTreatments(since ? Date.parse(since[1]) : 0));
+                } else if (/Authenticate|Login/.test(req.url)) {
+                    req.responseText = SYNTHETIC_ACCOUNT;
+                } else {
+                    var params = JSON.parse(body);
+                    var count = Math.min(params.maxCount, Math.floor(params.minutes * 60 / intervalSec));
+                    req.responseText = JSON.stringify(syntheticReadings(count, intervalSec));
+                }
+                if (req.onload) req.onload();
+            }, latency);
+        };
+    };
+}
+
+module.exports = {
+    createXhr: createXhr,
+    syntheticReadings: syntheticReadings,
+    syntheticTreatments: syntheticTreatments
+};
@@ -0,0 +1,95 @@
+/*
+ * Fake PebbleKit JS environment for running src/pkjs under Node.
+ *
+ * Installs globals for Pebble, localStorage and XMLHttpRequest. The fake
+ * XHR (bench/fake_dexcom.js) answers the Dexcom Share endpoints with
+ * synthetic readings and the Nightscout treatments endpoint with
+ * synthetic boluses. If pebble-clay is not installed it resolves to a
+ * stub, so the benchmarks run without `npm install`; install it to
+ * include Clay's real load cost.
+ */
+'use strict';
+
+var Module = require('module');
+var fakeDexcom = require('./fake_dexcom');
+
+function stubClay() {
+    function Clay() {}
+    Clay.prototype.generateUrl = function() { return 'data:text/html,'; };
+    Clay.prototype.getSettings = function() { return {}; };
+    return Clay;
+}
+
+function hookClay() {
+    var load = Module._load;
+    Module._load = function(request) {
+        if (request === 'pebble-clay') {
+            try {
+                return load.apply(this, arguments);
+            } catch (e) {
+                return stubClay();
+            }
+        }
+        return load.apply(this, arguments);
+    };
+}
+
+/**
+ * Install the fake environment
+ * @param {Object} options - settings (clay-settings object), cache (array of
+ *   {v, t}), latencyMs (fake network delay), intervalSec (sample spacing),
+ *   onSend (called with each outgoing AppMessage)
+ * @returns {Object} Handle with fire(event, data), sent, storage, xhrCount
+ */
+function install(options) {
+    options = options || {};
+    var storage = {};
+    var listeners = {};
+    var handle = { sent: [], storage: storage, xhrCount: 0 };
+
+    hookClay();
+
+    global.localStorage = {
+        getItem: function(k) { return Object.prototype.hasOwnProperty.call(storage, k) ? storage[k] : null; },
+        setItem: function(k, v) { storage[k] = String(v); },
+        removeItem: function(k) { delete storage[k]; }
+    };
+    global.window = global;
+
+    global.Pebble = {
+        addEventListener: function(name, fn) {
+            (listeners[name] = listeners[name] || []).push(fn);
+        },
+        sendAppMessage: function(msg, ok) {
+            handle.sent.push(msg);
+            if (options.onSend) options.onSend(msg);
+            setTimeout(function() { if (ok) ok({}); }, 0);
+        },
+        getActiveWatchInfo: function() { return { platform: options.platform || 'basalt' }; },
+        openURL: function() {}
+    };
+
+    global.XMLHttpRequest = fakeDexcom.createXhr({
+        latencyMs: options.latencyMs,
+        intervalSec: options.intervalSec,
+        onRequest: function() { handle.xhrCount++; }
+    });
+
+    storage['clay-settings'] = JSON.stringify(options.settings || {
+        DEX_LOGIN: 'bench', DEX_PASSWORD: 'bench', BG_UNITS: 'mg/dL'
+    });
+    if (options.cache) {
+        storage.glucose_cache = JSON.stringify(options.cache);
+    }
+
+    handle.fire = function(name, data) {
+        (listeners[name] || []).forEach(function(fn) { fn(data || {}); });
+    };
+    return handle;
+}
+
+module.exports = {
+    install: install,
+    syntheticReadings: fakeDexcom.syntheticReadings,
+    syntheticTreatments: fakeDexcom.syntheticTreatments
+};
@@ -0,0 +1,186 @@
+/*
+ * Phone-rendered chart benchmark: bytes on air and phone-side cost.
+ *
+ * Runs one live refresh of src/pkjs/index.js under the fake PebbleKit JS
+ * environment three times: with the watch drawing the chart (native),
+ * with the phone drawing it (PHONE_RENDER set for the platform) and with
+ * the phone projecting it (PHONE_PROJECT, after the watch has reported
+ * its layout), and reports for each:
+ *   messages    - AppMessages in the transfer
+ *   bytes       - their serialized dictionary size, as sent over the air
+ *   chartBytes  - of which CHART_RLE (the encoded bitmap) or the projected
+ *                 points, axis and labels
+ * plus the phone's time to draw and encode one chart (renderMs). The
+ * watch's side - frame and message handling times - is measured in the
+ * emulator: node bench/emulator.js --render phone --compare native.json
+ *
+ * Usage: node bench/render.js [--platform aplite] [--units mmol/L]
+ *            [--runs N] [--json]
+ */
+'use strict';
+
+var childProcess = require('child_process');
+var fs = require('fs');
+var path = require('path');
+
+var ROOT = path.join(__dirname, '..');
+var SETTLE_MS = 500;  /* After the last message, for the transfer to end */
+
+/* Dictionary serialization: a count byte, then per tuple a 4-byte key,
+   type byte and 2-byte length ahead of the value */
+var DICT_HEADER = 1;
+var TUPLE_HEADER = 7;
+var INT_SIZES = { int8: 1, uint8: 1, int16: 2, uint16: 2, int32: 4, uint32: 4 };
+
+function option(argv, name, fallback) {
+    var i = argv.indexOf(name);
+    return i >= 0 && i + 1 < argv.length ? argv[i + 1] : fallback;
+}
+
+function msSince(start) {
+    var d = process.hrtime(start);
+    return d[0] * 1e3 + d[1] / 1e6;
+}
+
+function keyTypes() {
+    var schema = JSON.parse(fs.readFileSync(path.join(ROOT, 'protocol', 'schema.json'), 'utf8'));
+    var types = {};
+    schema.keys.forEach(function(k) { types[k.name] = k.type; });
+    return types;
+}
+
+function dictSize(msg, types) {
+    var size = DICT_HEADER;
+    Object.keys(msg).forEach(function(key) {
+        var type = types[key];
+        var value = msg[key];
+        size += TUPLE_HEADER;
+        if (type === 'bytes') {
+            size += value.length;
+        } else if (type === 'cstring') {
+            size += Buffer.byteLength(String(value), 'utf8') + 1;
+        } else {
+            size += INT_SIZES[type];
+        }
+    });
+    return size;
+}
+
+/* The watch's ChartLayout, as src/c/main.c reports it */
+var WATCH_LAYOUT = {
+    chart_x: 30, chart_y: 10, chart_w: 114, chart_h: 122, padding: 2,
+    seconds_per_pixel: 100, label_w: 30, label_h: 16
+};
+var POINT_KEYS = ['POINTS_END', 'POINTS_AXIS', 'BG_POINTS', 'BG_YESTERDAY_POINTS', 'BG_LABELS'];
+
+/** Child: one live refresh in mode native|phone|points; prints the messages sent */
+function runChild(platform, units, mode) {
+    var fake = require('./fake_pebble');
+    var platforms = ['aplite', 'basalt', 'chalk', 'diorite', 'emery'];
+    var settings = { DEX_LOGIN: 'bench', DEX_PASSWORD: 'bench', BG_UNITS: units };
+    if (mode === 'phone') {
+        settings.PHONE_RENDER = platforms.map(function(p) { return p === platform; });
+    }
+    settings.PHONE_PROJECT = mode === 'points';
+    var timer = null;
+    var handle = fake.install({
+        platform: platform,
+        settings: settings,
+        onSend: function() {
+            clearTimeout(timer);
+            timer = setTimeout(function() {
+                process.stdout.write(JSON.stringify(handle.sent));
+                process.exit(0);
+            }, SETTLE_MS);
+        }
+    });
+    handle.storage.dexcom_account_id = 'bench-account';
+    handle.storage.dexcom_session_id = 'bench-session';
+    handle.storage.dexcom_region = 'ous';
+    handle.storage.chart_layout = JSON.stringify({ platform: platform, layout: WATCH_LAYOUT });
+    require(path.join(ROOT, 'src', 'pkjs', 'index.js'));
+    handle.fire('ready');
+}
+
+function chartBytes(msg, types) {
+    if (msg.CHART_RLE) return msg.CHART_RLE.length;
+    var part = {};
+    POINT_KEYS.forEach(function(key) {
+        if (key in msg) part[key] = msg[key];
+    });
+    return Object.keys(part).length ? dictSize(part, types) - DICT_HEADER : 0;
+}
+
+function transfer(platform, units, mode, types) {
+    var out = childProcess.execFileSync(process.execPath,
+        [__filename, '--child', platform, units, mode], {
+            encoding: 'utf8',
+            stdio: ['ignore', 'pipe', 'ignore']
+        });
+    var sent = JSON.parse(out);
+    return {
+        messages: sent.length,
+        bytes: sent.reduce(function(sum, msg) { return sum + dictSize(msg, types); }, 0),
+        chartBytes: sent.reduce(function(sum, msg) { return sum + chartBytes(msg, types); }, 0)
+    };
+}
+
+/** Phone-side draw + encode time over a synthetic day, median of runs */
+function renderMs(units, runs) {
+    var Render = require('../src/pkjs/render');
+    var now = Math.floor(Date.now() / 1000);
+    var readings = [];
+    for (var i = 0; i < 72; i++) {
+        var mgdl = Math.round(140 + 60 * Math.sin(i / 9));
+        readings.push({ v: units === 'mmol/L' ? Math.round(mgdl / 1.80182) : mgdl, t: now - i * 150 });
+    }
+    var times = [];
+    for (var r = 0; r < runs; r++) {
+        var start = process.hrtime();
+        Render.encode(Render.render({
+            readings: readings, yesterday: [], events: [], interval: 150,
+            isMmol: units === 'mmol/L', axisAuto: false, viewEnd: Render.viewEndAt(now)
+        }));
+        times.push(msSince(start));
+    }
+    times.sort(function(a, b) { return a - b; });
+    return +times[Math.floor(times.length / 2)].toFixed(3);
+}
+
+function main(argv) {
+    var platform = option(argv, '--platform', 'aplite');
+    var units = option(argv, '--units', 'mg/dL');
+    var runs = parseInt(option(argv, '--runs', '20'), 10) || 20;
+    var types = keyTypes();
+
+    var report = {
+        platform: platform,
+        units: units,
+        native: transfer(platform, units, 'native', types),
+        phone: transfer(platform, units, 'phone', types),
+        points: transfer(platform, units, 'points', types),
+        renderMs: renderMs(units, runs)
+    };
+    if (argv.indexOf('--json') >= 0) {
+        console.log(JSON.stringify(report, null, 2));
+    } else {
+        var extra = report.phone.bytes - report.native.bytes;
+        console.log('Platform:             ' + platform + ' (' + units + ')');
+        console.log('Native transfer:      ' + report.native.messages + ' messages, ' + report.native.bytes + ' bytes');
+        console.log('Phone-rendered:       ' + report.phone.messages + ' messages, ' + report.phone.bytes + ' bytes' +
+            ' (bitmap ' + report.phone.chartBytes + ', +' + Math.round(100 * extra / report.native.bytes) + '%)');
+        var pointsExtra = report.points.bytes - report.native.bytes;
+        console.log('Phone-projected:      ' + report.points.messages + ' messages, ' + report.points.bytes + ' bytes' +
+            ' (points ' + report.points.chartBytes + ', +' + Math.round(100 * pointsExtra / report.native.bytes) + '%)');
+        console.log('Phone draw + encode:  median ' + report.renderMs + ' ms');
+    }
+}
+
+if (process.argv.indexOf('--child') >= 0) {
+    /* Keep PebbleKit JS logging out of the measurement output */
+    console.log = console.error = function() {};
+    var i = process.argv.indexOf('--child');
+    runChild(process.argv[i + 1], process.argv[i + 2], process.argv[i + 3]);
+} else {
+    main(process.argv.slice(2));
+}
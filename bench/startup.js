@@ -0,0 +1,88 @@
+/*
+ * PebbleKit JS startup benchmark.
+ *
+ * Measures, in a fresh Node process per run:
+ *   evalMs      - evaluating src/pkjs/index.js (module load)
+ *   firstSendMs - from the start of evaluation to the first
+ *                 Pebble.sendAppMessage after the 'ready' event
+ * The fake Dexcom server answers instantly with a restored session, so
+ * the numbers reflect script work rather than network time.
+ *
+ * Usage: node bench/startup.js [--runs N] [--json]
+ */
+'use strict';
+
+var childProcess = require('child_process');
+var path = require('path');
+
+var INDEX = path.join(__dirname, '..', 'src', 'pkjs', 'index.js');
+
+function msSince(start) {
+    var d = process.hrtime(start);
+    return d[0] * 1e3 + d[1] / 1e6;
+}
+
+function runChild() {
+    var fake = require('./fake_pebble');
+    var start;
+    var handle = fake.install({
+        onSend: function() {
+            process.stdout.write(JSON.stringify({ evalMs: evalMs, firstSendMs: msSince(start) }));
+            process.exit(0);
+        }
+    });
+    /* Restored session: the hot path is one glucose request */
+    handle.storage.dexcom_account_id = 'bench-account';
+    handle.storage.dexcom_session_id = 'bench-session';
+    handle.storage.dexcom_region = 'ous';
+
+    start = process.hrtime();
+    require(INDEX);
+    var evalMs = msSince(start);
+    handle.fire('ready');
+}
+
+function stats(values) {
+    var sorted = values.slice().sort(function(a, b) { return a - b; });
+    var pick = function(q) { return sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))]; };
+    return {
+        median: +pick(0.5).toFixed(3),
+        p90: +pick(0.9).toFixed(3),
+        min: +sorted[0].toFixed(3)
+    };
+}
+
+function main(argv) {
+    var runs = 20;
+    var i = argv.indexOf('--runs');
+    if (i >= 0) runs = parseInt(argv[i + 1], 10) || runs;
+
+    var evals = [];
+    var sends = [];
+    for (var r = 0; r < runs; r++) {
+        var out = childProcess.execFileSync(process.execPath, [__filename, '--child'], {
+            encoding: 'utf8',
+            stdio: ['ignore', 'pipe', 'ignore']
+        });
+        var result = JSON.parse(out);
+        evals.push(result.evalMs);
+        sends.push(result.firstSendMs);
+    }
+
+    var report = { runs: runs, evalMs: stats(evals), firstSendMs: stats(sends) };
+    if (argv.indexOf('--json') >= 0) {
+        console.log(JSON.stringify(report, null, 2));
+    } else {
+        console.log('Runs:                 ' + runs);
+        console.log('Script evaluation:    median ' + report.evalMs.median + ' ms, p90 ' + report.evalMs.p90 + ' ms');
+        console.log('To first AppMessage:  median ' + report.firstSendMs.median + ' ms, p90 ' + report.firstSendMs.p90 + ' ms');
+    }
+}
+
+if (process.argv.indexOf('--child') >= 0) {
+    /* Keep PebbleKit JS logging out of the measurement output */
+    console.log = console.error = function() {};
+    runChild();
+} else {
+    main(process.argv.slice(2));
+}
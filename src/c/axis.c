@@ -0,0 +1,158 @@
+#include "axis.h"
+#include "log.h"
+
+/* Auto range: candidate grid steps (finest first), the most grid
+   intervals across the axis, and the narrowest span shown */
+#define AUTO_MAX_INTERVALS  5
+#define MGDL_MIN_SPAN      60
+#define MMOL_MIN_SPAN      30
+
+/* Narrow the auto range only when the new one is at most 2/3 as wide */
+#define SHRINK_NUM          2
+#define SHRINK_DEN          3
+
+static const int s_mgdl_steps[] = {20, 25, 50, 100};
+static const int s_mmol_steps[] = {10, 20, 25, 50};
+
+/* Fixed scale: 5 grid values */
+static const int s_mgdl_fixed[] = {0, 72, 180, 270, 360};
+static const int s_mmol_fixed[] = {0, 40, 100, 150, 200};
+
+static AxisScale s_scale;
+static int  s_x0       = 0;
+static int  s_width    = 1;
+static bool s_is_mmol  = false;
+static bool s_auto     = false;
+static bool s_valid    = false;
+
+static int value_x(int value) {
+    return s_x0 + ((value - s_scale.min_bg) * s_width) / s_scale.bg_range;
+}
+
+/** Append a line if it falls on the axis; thresholds merge with grid. */
+static void add_line(int value, bool solid, bool labelled) {
+    if (value < s_scale.min_bg || value > s_scale.min_bg + s_scale.bg_range) {
+        return;
+    }
+    for (int i = 0; i < s_scale.line_count; i++) {
+        if (s_scale.lines[i].value == value) {
+            s_scale.lines[i].solid |= solid;
+            return;
+        }
+    }
+    if (s_scale.line_count == AXIS_MAX_LINES) return;
+
+    AxisLine *line = &s_scale.lines[s_scale.line_count++];
+    line->value    = value;
+    line->x        = value_x(value);
+    line->solid    = solid;
+    line->labelled = labelled;
+    if (value == 0) {
+        snprintf(line->label, sizeof(line->label), "0");
+    } else if (s_is_mmol) {
+        snprintf(line->label, sizeof(line->label), "%d.%d", value / 10, value % 10);
+    } else {
+        snprintf(line->label, sizeof(line->label), "%d", value);
+    }
+}
+
+/** Rebuild the cached lines for [min_bg, min_bg + bg_range]. */
+static void build(int min_bg, int bg_range, int step) {
+    s_scale.min_bg     = min_bg;
+    s_scale.bg_range   = bg_range;
+    s_scale.line_count = 0;
+
+    if (step == 0) {
+        const int *grid = s_is_mmol ? s_mmol_fixed : s_mgdl_fixed;
+        for (int i = 0; i < 5; i++) {
+            add_line(grid[i], false, true);
+        }
+    } else {
+        for (int v = min_bg; v <= min_bg + bg_range; v += step) {
+            add_line(v, false, true);
+        }
+    }
+
+    /* Clinical thresholds: 4.0 / 10.0 mmol/L or 72 / 180 mg/dL */
+    add_line(s_is_mmol ?  40 :  72, true, step == 0);
+    add_line(s_is_mmol ? 100 : 180, true, step == 0);
+    s_valid = true;
+
+    LOG_DEBUG("Axis %d..%d step %d",
+              min_bg, min_bg + bg_range, step);
+}
+
+/** Smallest nice range covering [lo, hi]; returns its grid step. */
+static int fit(int lo, int hi, int *min_bg, int *bg_range) {
+    int min_span = s_is_mmol ? MMOL_MIN_SPAN : MGDL_MIN_SPAN;
+    if (hi - lo < min_span) {
+        int mid = (lo + hi) / 2;
+        lo = mid - min_span / 2;
+        hi = lo + min_span;
+    }
+    if (lo < 0) {
+        hi -= lo;
+        lo = 0;
+    }
+
+    const int *steps = s_is_mmol ? s_mmol_steps : s_mgdl_steps;
+    int step = 0;
+    for (int i = 0; i < 4; i++) {
+        step = steps[i];
+        int mn = (lo / step) * step;
+        int mx = ((hi + step - 1) / step) * step;
+        *min_bg   = mn;
+        *bg_range = mx - mn;
+        if (*bg_range / step <= AUTO_MAX_INTERVALS) break;
+    }
+    return step;
+}
+
+void axis_init(int x0, int width) {
+    s_x0    = x0;
+    s_width = width;
+    s_valid = false;
+}
+
+bool axis_update(bool is_mmol, bool auto_range, int lo, int hi) {
+    bool mode_changed = !s_valid || is_mmol != s_is_mmol || auto_range != s_auto;
+    s_is_mmol = is_mmol;
+    s_auto    = auto_range;
+
+    if (!auto_range || lo > hi) {
+        if (!mode_changed) return false;
+        /* Fixed scale; auto mode also starts from it until data shows */
+        build(0, is_mmol ? 200 : 360, 0);
+        return true;
+    }
+
+    int min_bg, bg_range;
+    int step = fit(lo, hi, &min_bg, &bg_range);
+
+    if (!mode_changed) {
+        bool inside = lo >= s_scale.min_bg &&
+                      hi <= s_scale.min_bg + s_scale.bg_range;
+        bool much_smaller = bg_range * SHRINK_DEN <= s_scale.bg_range * SHRINK_NUM;
+        if (inside && !much_smaller) return false;
+        if (min_bg == s_scale.min_bg && bg_range == s_scale.bg_range) return false;
+    }
+
+    build(min_bg, bg_range, step);
+    return true;
+}
+
+bool axis_set(bool is_mmol, bool auto_range, int min_bg, int bg_range, int step) {
+    bool mode_changed = !s_valid || is_mmol != s_is_mmol || auto_range != s_auto;
+    s_is_mmol = is_mmol;
+    s_auto    = auto_range;
+    if (bg_range <= 0) return false;
+    if (!mode_changed && min_bg == s_scale.min_bg && bg_range == s_scale.bg_range) {
+        return false;
+    }
+    build(min_bg, bg_range, step);
+    return true;
+}
+
+const AxisScale *axis_scale(void) {
+    return &s_scale;
+}
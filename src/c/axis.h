@@ -0,0 +1,52 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Glucose axis scale
+ *
+ * Either the fixed 0-360 mg/dL / 0-20 mmol/L axis or an auto range picked
+ * from the visible extrema, snapped to a "nice" grid step.  The grid lines,
+ * their pixel columns and label strings are cached and rebuilt only when
+ * the chosen scale changes; in auto mode the range widens as soon as data
+ * leaves it but narrows only once the data would fit a clearly smaller
+ * range, so it does not flap as readings come and go.
+ * --------------------------------------------------------------------------- */
+
+/* Grid steps plus the two threshold lines */
+#define AXIS_MAX_LINES  8
+
+typedef struct {
+    int  value;     /* BG value (x10 for mmol/L) */
+    int  x;         /* Pixel column */
+    bool solid;     /* Clinical threshold: always drawn, solid */
+    bool labelled;  /* Has a label below the axis */
+    char label[6];
+} AxisLine;
+
+typedef struct {
+    int      min_bg;
+    int      bg_range;
+    int      line_count;
+    AxisLine lines[AXIS_MAX_LINES];
+} AxisScale;
+
+/** Set the pixel columns the axis spans: [x0, x0 + width]. */
+void axis_init(int x0, int width);
+
+/**
+ * Pick the scale for the units, mode and visible extrema [lo, hi]
+ * (lo > hi when nothing is visible, which keeps the current range).
+ * Returns true when the scale changed and its lines were rebuilt.
+ */
+bool axis_update(bool is_mmol, bool auto_range, int lo, int hi);
+
+/**
+ * Adopt a scale picked elsewhere (the phone's, for projected points) as
+ * axis_update() would have picked it; later updates carry on from it.
+ * Returns true when the scale changed and its lines were rebuilt.
+ */
+bool axis_set(bool is_mmol, bool auto_range, int min_bg, int bg_range, int step);
+
+/** The scale currently in effect. */
+const AxisScale *axis_scale(void);
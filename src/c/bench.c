@@ -0,0 +1,69 @@
+#include "bench.h"
+
+#ifdef BENCH
+
+#include "energy.h"
+
+#if defined(PBL_PLATFORM_APLITE)
+#define BENCH_PLATFORM  "aplite"
+#elif defined(PBL_PLATFORM_BASALT)
+#define BENCH_PLATFORM  "basalt"
+#elif defined(PBL_PLATFORM_CHALK)
+#define BENCH_PLATFORM  "chalk"
+#elif defined(PBL_PLATFORM_DIORITE)
+#define BENCH_PLATFORM  "diorite"
+#elif defined(PBL_PLATFORM_EMERY)
+#define BENCH_PLATFORM  "emery"
+#else
+#define BENCH_PLATFORM  "unknown"
+#endif
+
+static uint32_t s_start_ms   = 0;
+static size_t   s_heap_peak  = 0;
+static bool     s_first_seen = false;
+
+/** Heap in use now; raises the high-water mark. */
+static size_t sample_heap(void) {
+    size_t used = heap_bytes_used();
+    if (used > s_heap_peak) s_heap_peak = used;
+    return used;
+}
+
+void bench_init(void) {
+    s_start_ms = energy_clock_ms();
+    size_t used = sample_heap();
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "BENCH {\"event\":\"start\",\"platform\":\"%s\",\"heap\":%d,\"heap_free\":%d}",
+            BENCH_PLATFORM, (int)used, (int)heap_bytes_free());
+}
+
+static const char *const s_frame_kinds[] = {
+    [BENCH_DRAWN]    = "drawn",
+    [BENCH_RESTORED] = "restored",
+    [BENCH_SCROLLED] = "scrolled",
+    [BENCH_BLITTED]  = "blitted"
+};
+
+void bench_frame(uint32_t render_ms, BenchFrameKind kind, bool has_data) {
+    size_t used = sample_heap();
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "BENCH {\"event\":\"frame\",\"render_ms\":%d,\"kind\":\"%s\",\"heap\":%d,\"heap_peak\":%d}",
+            (int)render_ms, s_frame_kinds[kind], (int)used, (int)s_heap_peak);
+    if (has_data && !s_first_seen) {
+        s_first_seen = true;
+        APP_LOG(APP_LOG_LEVEL_INFO, "BENCH {\"event\":\"first_chart\",\"ms\":%d}",
+                (int)(energy_clock_ms() - s_start_ms));
+    }
+}
+
+void bench_inbox(uint32_t start_ms, size_t bytes) {
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "BENCH {\"event\":\"inbox\",\"handle_ms\":%d,\"bytes\":%d}",
+            (int)(energy_clock_ms() - start_ms), (int)bytes);
+}
+
+void bench_sample(void) {
+    sample_heap();
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Benchmark probes
+ *
+ * Only built with BENCH defined (BENCH=1 pebble build); otherwise the
+ * macros expand to nothing.  Each probe logs one "BENCH {json}" line that
+ * bench/emulator.js collects from `pebble logs`: chart frame timings, the
+ * time spent handling each incoming message and its size, the time from
+ * launch to the first chart with data, and the heap high-water mark.
+ * --------------------------------------------------------------------------- */
+
+/** How a chart frame was produced. */
+typedef enum {
+    BENCH_DRAWN = 0,   /* Drawn in full */
+    BENCH_RESTORED,    /* Put back from the render memo */
+    BENCH_SCROLLED,    /* A scroll animation frame */
+    BENCH_BLITTED      /* The phone-rendered bitmap */
+} BenchFrameKind;
+
+#ifdef BENCH
+
+/** Mark the launch time. */
+void bench_init(void);
+
+/** A chart frame of the given kind took render_ms. */
+void bench_frame(uint32_t render_ms, BenchFrameKind kind, bool has_data);
+
+/** Handling an incoming message of bytes, begun at start_ms, is done. */
+void bench_inbox(uint32_t start_ms, size_t bytes);
+
+/** Sample the heap between frames (e.g. while a transfer is staged). */
+void bench_sample(void);
+
+#define BENCH_INIT()                        bench_init()
+#define BENCH_FRAME(render_ms, kind, data)  bench_frame(render_ms, kind, data)
+#define BENCH_INBOX(start_ms, bytes)        bench_inbox(start_ms, bytes)
+#define BENCH_SAMPLE()                      bench_sample()
+
+#else
+
+#define BENCH_INIT()
+#define BENCH_FRAME(render_ms, kind, data)  ((void)(kind))
+#define BENCH_INBOX(start_ms, bytes)        ((void)(start_ms))
+#define BENCH_SAMPLE()
+
+#endif
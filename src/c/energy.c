@@ -0,0 +1,62 @@
+#include "energy.h"
+#include "protocol.auto.h"
+
+static uint32_t s_counters[ENERGY_COUNTER_COUNT];
+static time_t   s_start_time;
+
+/* The packed report (protocol/schema.json) has one slot per counter */
+typedef char energy_report_fits_counters[
+    sizeof(((EnergyReport *)0)->counters) == sizeof(s_counters) ? 1 : -1];
+
+void energy_init(void) {
+    memset(s_counters, 0, sizeof(s_counters));
+    s_start_time = time(NULL);
+}
+
+void energy_add(EnergyCounter counter, uint32_t amount) {
+    s_counters[counter] += amount;
+}
+
+uint32_t energy_clock_ms(void) {
+    time_t seconds;
+    uint16_t millis;
+    time_ms(&seconds, &millis);
+    return (uint32_t)seconds * 1000 + millis;
+}
+
+/** Seconds in the measurement period, at least one minute so early
+    rates are not wildly extrapolated. */
+static uint32_t elapsed_seconds(void) {
+    uint32_t elapsed = (uint32_t)(time(NULL) - s_start_time);
+    return (elapsed < 60) ? 60 : elapsed;
+}
+
+static uint32_t per_hour(EnergyCounter counter) {
+    return (uint32_t)(((uint64_t)s_counters[counter] * 3600) / elapsed_seconds());
+}
+
+void energy_format(char *buf, size_t size) {
+    uint32_t redraws = s_counters[ENERGY_REDRAWS];
+    uint32_t avg_ms  = redraws ? s_counters[ENERGY_RENDER_MS] / redraws : 0;
+
+    snprintf(buf, size,
+             "Per hour (%d min)\n"
+             "Draws %d, avg %d ms\n"
+             "Render %d ms\n"
+             "Inbox %d, %d B\n"
+             "Sends %d\n"
+             "Wakeups %d",
+             (int)(elapsed_seconds() / 60),
+             (int)per_hour(ENERGY_REDRAWS), (int)avg_ms,
+             (int)per_hour(ENERGY_RENDER_MS),
+             (int)per_hour(ENERGY_INBOX_MSGS), (int)per_hour(ENERGY_INBOX_BYTES),
+             (int)per_hour(ENERGY_OUTBOX_SENDS),
+             (int)per_hour(ENERGY_WAKEUPS));
+}
+
+void energy_pack(uint8_t *buf) {
+    EnergyReport report;
+    report.elapsed = (uint32_t)(time(NULL) - s_start_time);
+    memcpy(report.counters, s_counters, sizeof(report.counters));
+    proto_encode_energy_report(&report, buf);
+}
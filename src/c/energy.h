@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Energy counters
+ *
+ * Cheap running totals of the work that costs battery: redraws and their
+ * render time, AppMessage traffic and wakeups.  Shown as hourly rates in
+ * the hidden debug overlay and exported to the phone log on demand.
+ * --------------------------------------------------------------------------- */
+
+typedef enum {
+    ENERGY_REDRAWS = 0,    /* chart_layer_update_proc calls */
+    ENERGY_RENDER_MS,      /* Time spent in chart_layer_update_proc */
+    ENERGY_INBOX_MSGS,     /* AppMessages received */
+    ENERGY_INBOX_BYTES,    /* ...and their dictionary size */
+    ENERGY_OUTBOX_SENDS,   /* AppMessages sent */
+    ENERGY_WAKEUPS,        /* Tick handler and app timer callbacks */
+    ENERGY_COUNTER_COUNT
+} EnergyCounter;
+
+/** Start the measurement period. */
+void energy_init(void);
+
+void energy_add(EnergyCounter counter, uint32_t amount);
+
+/** Millisecond clock for timing code sections (wraps; use differences). */
+uint32_t energy_clock_ms(void);
+
+/** Format hourly rates for the debug overlay. */
+void energy_format(char *buf, size_t size);
+
+/** Fill buf (BYTES_PER_ENERGY_REPORT long, see protocol.auto.h) with the
+    packed report. */
+void energy_pack(uint8_t *buf);
@@ -0,0 +1,50 @@
+#include "events.h"
+
+static TreatmentEvent s_events[EVENTS_CAPACITY];
+static int s_count = 0;
+
+int events_count(void) {
+    return s_count;
+}
+
+const TreatmentEvent *events_get(int index) {
+    return &s_events[index];
+}
+
+void events_clear(void) {
+    s_count = 0;
+}
+
+int events_lower_bound(time_t ts) {
+    int lo = 0;
+    int hi = s_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s_events[mid].timestamp > ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void events_replace(time_t start, time_t end,
+                    const TreatmentEvent *incoming, int count) {
+    /* The stored events inside [start, end] form one contiguous run:
+       [newer, older) in newest-first order. */
+    int newer = events_lower_bound(end);
+    int older = events_lower_bound(start - 1);
+    int tail  = s_count - older;
+
+    /* Keep every newer event, then as many incoming and older events as
+       fit; the oldest are dropped on overflow. */
+    int room = EVENTS_CAPACITY - newer;
+    int in   = (count < room) ? count : room;
+    int keep = (tail < room - in) ? tail : room - in;
+
+    memmove(&s_events[newer + in], &s_events[older],
+            keep * sizeof(TreatmentEvent));
+    memcpy(&s_events[newer], incoming, in * sizeof(TreatmentEvent));
+    s_count = newer + in + keep;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Treatment event store
+ *
+ * Insulin and carb events from the phone, sorted newest first like the
+ * glucose history so the visible ones can be found by binary search.  Each
+ * transfer carries every event in the time range it covers; that range is
+ * replaced wholesale, so treatments deleted on the phone disappear here too.
+ * --------------------------------------------------------------------------- */
+
+/* 24 hours at a generous 2-3 treatments per hour (512 bytes) */
+#define EVENTS_CAPACITY  64
+
+typedef enum {
+    EVENT_INSULIN = 1,  /* amount in 0.1 U */
+    EVENT_CARBS   = 2   /* amount in grams */
+} EventKind;
+
+typedef struct {
+    time_t  timestamp;
+    uint8_t kind;
+    uint8_t amount;
+} TreatmentEvent;
+
+/** Number of events currently held. */
+int events_count(void);
+
+/** Event at index (0 = newest).  Index must be < events_count(). */
+const TreatmentEvent *events_get(int index);
+
+/** Drop every stored event. */
+void events_clear(void);
+
+/**
+ * Replace the stored events with timestamps in [start, end] by incoming
+ * (sorted newest first).  When the store overflows, the oldest events are
+ * dropped.
+ */
+void events_replace(time_t start, time_t end,
+                    const TreatmentEvent *incoming, int count);
+
+/**
+ * Index of the newest event with timestamp <= ts (binary search).
+ * Returns events_count() when every event is newer than ts.
+ */
+int events_lower_bound(time_t ts);
@@ -0,0 +1,84 @@
+#include "frame.h"
+#include "energy.h"
+#include "log.h"
+
+/* Distinct layers that can be pending at once */
+#define FRAME_MAX_LAYERS  4
+
+static Layer    *s_dirty[FRAME_MAX_LAYERS];
+static int       s_dirty_count     = 0;
+static uint32_t  s_budget_ms       = 0;
+static uint32_t  s_last_flush_ms   = 0;
+static AppTimer *s_deadline_timer  = NULL;
+static bool      s_in_focus        = true;
+
+/** Mark every collected layer dirty; the system draws them together. */
+static void flush(void) {
+    LOG_DEBUG("Frame: %d layers", s_dirty_count);
+    for (int i = 0; i < s_dirty_count; i++) {
+        layer_mark_dirty(s_dirty[i]);
+    }
+    s_dirty_count   = 0;
+    s_last_flush_ms = energy_clock_ms();
+}
+
+static void deadline_callback(void *context) {
+    s_deadline_timer = NULL;
+    energy_add(ENERGY_WAKEUPS, 1);
+    if (s_in_focus && s_dirty_count > 0) {
+        flush();
+    }
+}
+
+/** Flush now if the budget allows, otherwise at the deadline. */
+static void schedule(void) {
+    if (s_deadline_timer || !s_in_focus || s_dirty_count == 0) return;
+
+    uint32_t since = energy_clock_ms() - s_last_flush_ms;
+    if (since >= s_budget_ms) {
+        flush();
+    } else {
+        s_deadline_timer = app_timer_register(s_budget_ms - since,
+                                              deadline_callback, NULL);
+    }
+}
+
+static void focus_handler(bool in_focus) {
+    s_in_focus = in_focus;
+    if (in_focus) {
+        schedule();
+    }
+}
+
+void frame_init(uint32_t budget_ms) {
+    s_budget_ms = budget_ms;
+    app_focus_service_subscribe(focus_handler);
+}
+
+void frame_deinit(void) {
+    app_focus_service_unsubscribe();
+    if (s_deadline_timer) {
+        app_timer_cancel(s_deadline_timer);
+        s_deadline_timer = NULL;
+    }
+}
+
+void frame_request(Layer *layer) {
+    if (!layer) return;
+
+    bool found = false;
+    for (int i = 0; i < s_dirty_count; i++) {
+        if (s_dirty[i] == layer) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        if (s_dirty_count == FRAME_MAX_LAYERS) {
+            /* Out of slots: draw what is pending right away */
+            flush();
+        }
+        s_dirty[s_dirty_count++] = layer;
+    }
+    schedule();
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Frame scheduler
+ *
+ * All redraw requests go through here instead of layer_mark_dirty.  Dirty
+ * layers are collected and flushed at most once per frame budget, so
+ * bursts of messages cost one frame rather than one per message.  Frames
+ * are held back while the app is out of focus (e.g. covered by a
+ * notification) and flushed when it returns.  The firmware redraws whole
+ * layers, so a request carries no reason: each layer's update procedure
+ * works out from its own inputs what changed (see memo.h).
+ * --------------------------------------------------------------------------- */
+
+/** Start the scheduler with the minimum interval between frames. */
+void frame_init(uint32_t budget_ms);
+
+void frame_deinit(void);
+
+/** Request a redraw of layer. */
+void frame_request(Layer *layer);
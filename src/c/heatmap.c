@@ -0,0 +1,239 @@
+#include "heatmap.h"
+#include "request.h"
+
+#define TITLE_HEIGHT   20
+#define LABEL_WIDTH    24  /* Weekday names left of the rows */
+#define HOUR_HEIGHT    16  /* Hour labels under the rows */
+#define SIDE_INSET     PBL_IF_ROUND_ELSE(18, 2)
+#define MAX_CELL_H     24
+
+typedef enum {
+    LEVEL_NONE = 0,     /* No readings: left blank */
+    LEVEL_LOW,          /* Below 70 mg/dL */
+    LEVEL_TARGET,       /* 70-140 */
+    LEVEL_UPPER,        /* 140-180 */
+    LEVEL_HIGH,         /* 180-250 */
+    LEVEL_VERY_HIGH,    /* Above 250 */
+    LEVEL_COUNT
+} Level;
+
+/* Level boundaries, x10 in each unit */
+static const int s_mgdl_bounds[] = {700, 1400, 1800, 2500};
+static const int s_mmol_bounds[] = { 39,   78,  100,  139};
+
+#ifdef PBL_COLOR
+static GColor s_level_colors[LEVEL_COUNT];
+#else
+/* Dark pixels per 4x4 tile, by level */
+static const uint8_t s_level_density[LEVEL_COUNT] = {0, 16, 2, 4, 8, 12};
+/* 4x4 ordered-dither thresholds */
+static const uint8_t s_bayer[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+static GBitmap *s_patterns[LEVEL_COUNT];
+#endif
+
+static Window     *s_window  = NULL;
+static Layer      *s_layer   = NULL;
+static HeatmapCell s_cells[HEATMAP_CELLS];
+static int         s_count   = 0;
+static time_t      s_start   = 0;
+static bool        s_is_mmol = false;
+static GPoint      s_origin;
+static GSize       s_cell;
+
+static Level cell_level(int mean) {
+    if (mean <= 0) return LEVEL_NONE;
+    const int *bounds = s_is_mmol ? s_mmol_bounds : s_mgdl_bounds;
+    if (mean < bounds[0])  return LEVEL_LOW;
+    if (mean < bounds[1])  return LEVEL_TARGET;
+    if (mean <= bounds[2]) return LEVEL_UPPER;
+    if (mean <= bounds[3]) return LEVEL_HIGH;
+    return LEVEL_VERY_HIGH;
+}
+
+#ifndef PBL_COLOR
+/** A cell-sized 1-bit bitmap dithered to density/16 dark pixels. */
+static GBitmap *create_pattern(GSize size, int density) {
+    GBitmap *bitmap = gbitmap_create_blank(size, GBitmapFormat1Bit);
+    if (!bitmap) return NULL;
+    uint8_t *data = gbitmap_get_data(bitmap);
+    int row_bytes = gbitmap_get_bytes_per_row(bitmap);
+    for (int y = 0; y < size.h; y++) {
+        for (int x = 0; x < size.w; x++) {
+            /* Set bits are white; blank bitmaps start out black */
+            if (s_bayer[y % 4][x % 4] >= density) {
+                data[y * row_bytes + x / 8] |= (uint8_t)(1 << (x % 8));
+            }
+        }
+    }
+    return bitmap;
+}
+#endif
+
+/** Build the per-level patterns for the current cell size. */
+static void build_patterns(void) {
+#ifdef PBL_COLOR
+    s_level_colors[LEVEL_NONE]      = GColorWhite;
+    s_level_colors[LEVEL_LOW]       = GColorRed;
+    s_level_colors[LEVEL_TARGET]    = GColorIslamicGreen;
+    s_level_colors[LEVEL_UPPER]     = GColorMintGreen;
+    s_level_colors[LEVEL_HIGH]      = GColorChromeYellow;
+    s_level_colors[LEVEL_VERY_HIGH] = GColorOrange;
+#else
+    GSize size = GSize(s_cell.w - 1, s_cell.h - 1);
+    for (int i = LEVEL_LOW; i < LEVEL_COUNT; i++) {
+        s_patterns[i] = create_pattern(size, s_level_density[i]);
+    }
+#endif
+}
+
+static void destroy_patterns(void) {
+#ifndef PBL_COLOR
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        if (s_patterns[i]) {
+            gbitmap_destroy(s_patterns[i]);
+            s_patterns[i] = NULL;
+        }
+    }
+#endif
+}
+
+/** One draw call per cell; a 1 px gap separates neighbours. */
+static void draw_cell(GContext *ctx, GRect rect, Level level) {
+    if (level == LEVEL_NONE) return;
+#ifdef PBL_COLOR
+    graphics_context_set_fill_color(ctx, s_level_colors[level]);
+    graphics_fill_rect(ctx, rect, 0, GCornerNone);
+#else
+    if (s_patterns[level]) {
+        graphics_draw_bitmap_in_rect(ctx, s_patterns[level], rect);
+    }
+#endif
+}
+
+static void heatmap_layer_update_proc(Layer *layer, GContext *ctx) {
+    GRect bounds = layer_get_bounds(layer);
+    GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+
+    graphics_context_set_text_color(ctx, GColorBlack);
+    graphics_draw_text(ctx, "Last 7 days",
+                       fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD),
+                       GRect(0, 0, bounds.size.w, TITLE_HEIGHT),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentCenter, NULL);
+
+    if (s_count == 0) {
+        graphics_draw_text(ctx, "Waiting for phone", font,
+                           GRect(0, TITLE_HEIGHT, bounds.size.w, 20),
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentCenter, NULL);
+        return;
+    }
+
+    GRect cell = GRect(0, 0, s_cell.w - 1, s_cell.h - 1);
+    for (int i = 0; i < s_count; i++) {
+        cell.origin.x = s_origin.x + (i % 24) * s_cell.w;
+        cell.origin.y = s_origin.y + (i / 24) * s_cell.h;
+        draw_cell(ctx, cell, cell_level(s_cells[i].mean));
+    }
+
+    /* Outline the current hour: the row of today's local noon, which a
+       DST shift moves by an hour at most, and the local hour */
+    time_t now = time(NULL);
+    struct tm *local = localtime(&now);
+    time_t noon = now - (local->tm_hour * SECONDS_PER_HOUR + local->tm_min * 60 +
+                         local->tm_sec) + SECONDS_PER_DAY / 2;
+    int now_row = noon >= s_start ? (int)((noon - s_start) / SECONDS_PER_DAY) : -1;
+    int now_index = now_row >= 0 ? now_row * 24 + local->tm_hour : -1;
+    if (now_index >= 0 && now_index < s_count) {
+        graphics_context_set_stroke_color(ctx, GColorBlack);
+        graphics_draw_rect(ctx, GRect(s_origin.x + (now_index % 24) * s_cell.w - 1,
+                                      s_origin.y + (now_index / 24) * s_cell.h - 1,
+                                      s_cell.w + 1, s_cell.h + 1));
+    }
+
+    /* Weekday per row; noon keeps DST shifts off the day boundary */
+    char label[8];
+    int rows = (s_count + 23) / 24;
+    for (int row = 0; row < rows; row++) {
+        time_t day = s_start + row * SECONDS_PER_DAY + SECONDS_PER_DAY / 2;
+        strftime(label, sizeof(label), "%a", localtime(&day));
+        graphics_draw_text(ctx, label, font,
+                           GRect(SIDE_INSET, s_origin.y + row * s_cell.h +
+                                 (s_cell.h - 18) / 2, LABEL_WIDTH, 18),
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentLeft, NULL);
+    }
+
+    /* Hour ticks every 6 hours */
+    int hours_y = s_origin.y + rows * s_cell.h;
+    for (int hour = 0; hour < 24; hour += 6) {
+        snprintf(label, sizeof(label), "%d", hour);
+        graphics_draw_text(ctx, label, font,
+                           GRect(s_origin.x + hour * s_cell.w, hours_y, 20,
+                                 HOUR_HEIGHT),
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentLeft, NULL);
+    }
+}
+
+static void heatmap_window_load(Window *window) {
+    Layer *window_layer = window_get_root_layer(window);
+    GRect bounds = layer_get_bounds(window_layer);
+
+    int grid_w = bounds.size.w - 2 * SIDE_INSET - LABEL_WIDTH;
+    int grid_h = bounds.size.h - TITLE_HEIGHT - HOUR_HEIGHT -
+                 PBL_IF_ROUND_ELSE(24, 4);
+    s_cell = GSize(grid_w / 24, grid_h / HEATMAP_DAYS);
+    if (s_cell.h > MAX_CELL_H) s_cell.h = MAX_CELL_H;
+    s_origin = GPoint(SIDE_INSET + LABEL_WIDTH +
+                          (grid_w - 24 * s_cell.w) / 2,
+                      TITLE_HEIGHT + PBL_IF_ROUND_ELSE(8, 0));
+    build_patterns();
+
+    s_layer = layer_create(bounds);
+    layer_set_update_proc(s_layer, heatmap_layer_update_proc);
+    layer_add_child(window_layer, s_layer);
+}
+
+static void heatmap_window_unload(Window *window) {
+    layer_destroy(s_layer);
+    s_layer = NULL;
+    destroy_patterns();
+}
+
+void heatmap_update(const HeatmapCell *cells, int count, time_t start,
+                    bool is_mmol) {
+    if (count > HEATMAP_CELLS) count = HEATMAP_CELLS;
+    memcpy(s_cells, cells, count * sizeof(HeatmapCell));
+    s_count   = count;
+    s_start   = start;
+    s_is_mmol = is_mmol;
+    if (s_layer) {
+        layer_mark_dirty(s_layer);
+    }
+}
+
+void heatmap_window_push(void) {
+    if (!s_window) {
+        s_window = window_create();
+        window_set_background_color(s_window, GColorWhite);
+        window_set_window_handlers(s_window, (WindowHandlers){
+            .load   = heatmap_window_load,
+            .unload = heatmap_window_unload
+        });
+    }
+    window_stack_push(s_window, true);
+    request_heatmap();
+}
+
+void heatmap_deinit(void) {
+    if (s_window) {
+        window_destroy(s_window);
+        s_window = NULL;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * Weekly heatmap
+ *
+ * Mean glucose for every hour of the last HEATMAP_DAYS local days, one row
+ * per day.  The phone derives the matrix from its rolling statistics and
+ * sends it in one message on request; cells are coloured on colour
+ * platforms and dithered on black and white ones, from patterns built once
+ * per window so each cell costs a single draw call.
+ * --------------------------------------------------------------------------- */
+
+/**
+ * Store a heatmap (count cells row by row from local midnight start; means
+ * x10 in the given units) and redraw it if the window is open.
+ */
+void heatmap_update(const HeatmapCell *cells, int count, time_t start,
+                    bool is_mmol);
+
+/** Push the heatmap window and ask the phone for a fresh matrix. */
+void heatmap_window_push(void);
+
+/** Destroy the heatmap window. */
+void heatmap_deinit(void);
@@ -0,0 +1,79 @@
+#include "history.h"
+
+static GlucoseReading s_readings[HISTORY_CAPACITY];
+static int s_count = 0;
+static uint32_t s_generation = 0;
+
+int history_count(void) {
+    return s_count;
+}
+
+const GlucoseReading *history_get(int index) {
+    return &s_readings[index];
+}
+
+void history_clear(void) {
+    s_count = 0;
+    s_generation++;
+}
+
+uint32_t history_generation(void) {
+    return s_generation;
+}
+
+const GlucoseReading *history_readings(void) {
+    return s_readings;
+}
+
+int readings_lower_bound(const GlucoseReading *readings, int count, time_t ts) {
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (readings[mid].timestamp > ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int history_lower_bound(time_t ts) {
+    return readings_lower_bound(s_readings, s_count, ts);
+}
+
+void history_merge(const GlucoseReading *incoming, int count) {
+    if (count <= 0) return;
+
+    /* Pass 1: drop stored readings that the incoming batch replaces.
+       Both lists are sorted newest first, so one two-pointer sweep suffices. */
+    int kept = 0;
+    int j = 0;
+    for (int i = 0; i < s_count; i++) {
+        while (j < count && incoming[j].timestamp > s_readings[i].timestamp) j++;
+        if (j < count && incoming[j].timestamp == s_readings[i].timestamp) continue;
+        s_readings[kept++] = s_readings[i];
+    }
+
+    /* Pass 2: merge from the oldest end so the store can be written in
+       place.  The write index never falls below the read index, and
+       anything beyond HISTORY_CAPACITY (the oldest readings) is dropped. */
+    int i = kept - 1;
+    j = count - 1;
+    int total = kept + count;
+    for (int k = total - 1; k >= 0; k--) {
+        GlucoseReading next;
+        if (j < 0 || (i >= 0 && s_readings[i].timestamp < incoming[j].timestamp)) {
+            next = s_readings[i--];
+        } else {
+            next = incoming[j--];
+        }
+        if (k < HISTORY_CAPACITY) {
+            s_readings[k] = next;
+        }
+    }
+
+    s_count = (total < HISTORY_CAPACITY) ? total : HISTORY_CAPACITY;
+    s_generation++;
+}
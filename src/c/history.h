@@ -0,0 +1,53 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * In-RAM glucose history store
+ *
+ * Readings are kept sorted newest first (index 0 = most recent), the same
+ * order the phone sends them in.  Older pages fetched while panning are
+ * merged in behind the live window, so the store never needs re-sorting.
+ * --------------------------------------------------------------------------- */
+
+/* 24 hours at MIN_SAMPLE_INTERVAL, the densest the phone sends (4.6 KB) */
+#define HISTORY_CAPACITY  576
+
+typedef struct {
+    int16_t value;      /* BG value x10 for mmol/L precision (e.g. 123 mg/dL = 1230) */
+    time_t  timestamp;
+} GlucoseReading;
+
+/** Number of readings currently held. */
+int history_count(void);
+
+/** Reading at index (0 = newest).  Index must be < history_count(). */
+const GlucoseReading *history_get(int index);
+
+/** All stored readings, newest first; valid until the next merge or clear. */
+const GlucoseReading *history_readings(void);
+
+/** Drop every stored reading. */
+void history_clear(void);
+
+/** Counter bumped by every merge or clear, for caches derived from the store. */
+uint32_t history_generation(void);
+
+/**
+ * Merge readings (sorted newest first) into the store.
+ * Readings whose timestamp is already stored are replaced; when the store
+ * overflows, the oldest readings are dropped.
+ */
+void history_merge(const GlucoseReading *incoming, int count);
+
+/**
+ * Index of the newest reading with timestamp <= ts (binary search).
+ * Returns history_count() when every reading is newer than ts.
+ */
+int history_lower_bound(time_t ts);
+
+/**
+ * Index of the newest of count readings (sorted newest first) with
+ * timestamp <= ts.  Returns count when every reading is newer than ts.
+ */
+int readings_lower_bound(const GlucoseReading *readings, int count, time_t ts);
@@ -0,0 +1,222 @@
+#include "journal.h"
+#include "log.h"
+
+/* Persist keys owned by this module; power.c owns keys 1 and 2 */
+#define PERSIST_KEY_INDEX          100
+#define PERSIST_KEY_FIRST_SEGMENT  101
+
+#define JOURNAL_FORMAT        1  /* Bump when the packing changes */
+#define BYTES_PER_ENTRY       6  /* int16 value, uint32 timestamp */
+
+typedef struct {
+    uint8_t format;
+    uint8_t tail;     /* Oldest segment */
+    uint8_t head;     /* Segment being appended to */
+    uint8_t is_mmol;
+} JournalIndex;
+
+static JournalIndex s_index;
+static bool    s_loaded    = false;  /* s_index and s_head mirror persist */
+static uint8_t s_head[JOURNAL_SEGMENT_READINGS * BYTES_PER_ENTRY];
+static int     s_head_count = 0;
+static time_t  s_newest     = 0;     /* Newest journaled timestamp */
+static uint8_t s_buf[JOURNAL_SEGMENT_READINGS * BYTES_PER_ENTRY];  /* Other segments */
+
+static uint32_t segment_key(int segment) {
+    return PERSIST_KEY_FIRST_SEGMENT + segment;
+}
+
+static void pack_entry(uint8_t *p, const GlucoseReading *r) {
+    uint32_t ts = (uint32_t)r->timestamp;
+    p[0] = (uint16_t)r->value & 0xFF;
+    p[1] = (uint16_t)r->value >> 8;
+    p[2] = ts & 0xFF;
+    p[3] = (ts >> 8) & 0xFF;
+    p[4] = (ts >> 16) & 0xFF;
+    p[5] = ts >> 24;
+}
+
+static void unpack_entry(const uint8_t *p, GlucoseReading *r) {
+    r->value = (int16_t)(p[0] | (p[1] << 8));
+    r->timestamp = (time_t)((uint32_t)p[2] | ((uint32_t)p[3] << 8) |
+                            ((uint32_t)p[4] << 16) | ((uint32_t)p[5] << 24));
+}
+
+static void write_index(void) {
+    persist_write_data(PERSIST_KEY_INDEX, &s_index, sizeof(s_index));
+}
+
+/** Read a segment into buf; returns its reading count. */
+static int read_segment(int segment, uint8_t *buf) {
+    int size = persist_get_size(segment_key(segment));
+    if (size <= 0) return 0;
+    if (size > (int)sizeof(s_head)) size = sizeof(s_head);
+    persist_read_data(segment_key(segment), buf, size);
+    return size / BYTES_PER_ENTRY;
+}
+
+/** Start an empty journal in the given units. */
+static void reset(bool is_mmol) {
+    journal_clear();
+    s_index = (JournalIndex){
+        .format = JOURNAL_FORMAT, .tail = 0, .head = 0, .is_mmol = is_mmol
+    };
+    write_index();
+    s_loaded = true;
+}
+
+/** Move the head to the next segment, dropping the tail if it is needed. */
+static void open_segment(void) {
+    int next = (s_index.head + 1) % JOURNAL_SEGMENTS;
+    if (next == s_index.tail) {
+        persist_delete(segment_key(s_index.tail));
+        s_index.tail = (s_index.tail + 1) % JOURNAL_SEGMENTS;
+    }
+    s_index.head = next;
+    s_head_count = 0;
+    write_index();
+}
+
+bool journal_load(time_t since, bool *is_mmol) {
+    s_loaded = false;
+    if (persist_get_size(PERSIST_KEY_INDEX) != sizeof(s_index)) return false;
+    persist_read_data(PERSIST_KEY_INDEX, &s_index, sizeof(s_index));
+    if (s_index.format != JOURNAL_FORMAT || s_index.tail >= JOURNAL_SEGMENTS ||
+        s_index.head >= JOURNAL_SEGMENTS) {
+        journal_clear();
+        return false;
+    }
+    s_loaded = true;
+    s_head_count = read_segment(s_index.head, s_head);
+    s_newest = 0;
+
+    /* Drop segments that have expired entirely (their newest reading is
+       the last one); when even the head has, start over */
+    for (;;) {
+        const uint8_t *data = s_head;
+        int n = s_head_count;
+        if (s_index.tail != s_index.head) {
+            data = s_buf;
+            n = read_segment(s_index.tail, s_buf);
+        }
+        GlucoseReading newest;
+        if (n > 0) unpack_entry(data + (n - 1) * BYTES_PER_ENTRY, &newest);
+        if (n > 0 && newest.timestamp >= since) break;
+        if (s_index.tail == s_index.head) {
+            journal_clear();
+            return false;
+        }
+        persist_delete(segment_key(s_index.tail));
+        s_index.tail = (s_index.tail + 1) % JOURNAL_SEGMENTS;
+        write_index();
+    }
+
+    /* Merge segment by segment, newest first, each reversed into the
+       store's newest-first order */
+    static GlucoseReading readings[JOURNAL_SEGMENT_READINGS];
+    int segment = s_index.head;
+    for (;;) {
+        const uint8_t *data = s_buf;
+        int n;
+        if (segment == s_index.head) {
+            data = s_head;
+            n = s_head_count;
+        } else {
+            n = read_segment(segment, s_buf);
+        }
+        int count = 0;
+        for (int i = n - 1; i >= 0; i--) {
+            unpack_entry(data + i * BYTES_PER_ENTRY, &readings[count]);
+            if (readings[count].timestamp < since) break;
+            count++;
+        }
+        if (s_newest == 0 && count > 0) {
+            s_newest = readings[0].timestamp;
+        }
+        history_merge(readings, count);
+        if (segment == s_index.tail) break;
+        segment = (segment + JOURNAL_SEGMENTS - 1) % JOURNAL_SEGMENTS;
+    }
+
+    *is_mmol = s_index.is_mmol;
+    LOG_INFO("Journal: %d readings from %d segments",
+             history_count(),
+             (s_index.head - s_index.tail + JOURNAL_SEGMENTS) % JOURNAL_SEGMENTS + 1);
+    return history_count() > 0;
+}
+
+/**
+ * Write the stored readings older than the oldest journaled one into the
+ * free segments behind the tail, newest first, so panned-in pages survive
+ * a restart.  Never drops journaled readings to make room.
+ */
+static void backfill(void) {
+    const uint8_t *data = s_head;
+    int n = s_head_count;
+    if (s_index.tail != s_index.head) {
+        data = s_buf;
+        n = read_segment(s_index.tail, s_buf);
+    }
+    if (n == 0) return;
+    GlucoseReading oldest;
+    unpack_entry(data, &oldest);
+
+    int first = history_lower_bound(oldest.timestamp - 1);
+    int count = history_count();
+    bool moved = false;
+    while (first < count) {
+        int segment = (s_index.tail + JOURNAL_SEGMENTS - 1) % JOURNAL_SEGMENTS;
+        if (segment == s_index.head) break;  /* Ring full */
+        n = count - first;
+        if (n > JOURNAL_SEGMENT_READINGS) n = JOURNAL_SEGMENT_READINGS;
+        /* Readings first .. first + n - 1, written oldest first */
+        for (int k = 0; k < n; k++) {
+            pack_entry(s_buf + k * BYTES_PER_ENTRY, history_get(first + n - 1 - k));
+        }
+        persist_write_data(segment_key(segment), s_buf, n * BYTES_PER_ENTRY);
+        s_index.tail = segment;
+        first += n;
+        moved = true;
+    }
+    if (moved) {
+        write_index();
+    }
+}
+
+void journal_sync(bool is_mmol) {
+    if (!s_loaded || s_index.is_mmol != is_mmol) {
+        reset(is_mmol);
+    }
+
+    /* Stored readings newer than the journal, oldest first */
+    for (int i = history_lower_bound(s_newest) - 1; i >= 0; i--) {
+        if (s_head_count == JOURNAL_SEGMENT_READINGS) {
+            open_segment();
+        }
+        pack_entry(s_head + s_head_count * BYTES_PER_ENTRY, history_get(i));
+        s_head_count++;
+        s_newest = history_get(i)->timestamp;
+
+        /* One write per segment touched: when it fills, or at the end */
+        if (s_head_count == JOURNAL_SEGMENT_READINGS || i == 0) {
+            persist_write_data(segment_key(s_index.head), s_head,
+                               s_head_count * BYTES_PER_ENTRY);
+        }
+    }
+
+    backfill();
+}
+
+void journal_clear(void) {
+    for (int segment = 0; segment < JOURNAL_SEGMENTS; segment++) {
+        if (persist_exists(segment_key(segment))) {
+            persist_delete(segment_key(segment));
+        }
+    }
+    if (persist_exists(PERSIST_KEY_INDEX)) {
+        persist_delete(PERSIST_KEY_INDEX);
+    }
+    s_loaded     = false;
+    s_head_count = 0;
+    s_newest     = 0;
+}
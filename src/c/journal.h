@@ -0,0 +1,40 @@
+#pragma once
+
+#include <pebble.h>
+#include "history.h"
+
+/* ---------------------------------------------------------------------------
+ * Persisted history journal
+ *
+ * Live readings are appended, packed, to a ring of persist keys so hours
+ * of history survive an app restart without a snapshot of the whole store
+ * being rewritten; older pages panned in are written behind the oldest
+ * segment while the ring has free keys.  Each segment key holds up to JOURNAL_SEGMENT_READINGS
+ * readings, oldest first; a small index key records the oldest (tail) and
+ * the open (head) segment and the units the values are in.  The head
+ * segment is mirrored in RAM, so a refresh costs a single write of it; the
+ * index is only rewritten when a segment fills.  Segments are compacted
+ * lazily: the tail is dropped when the ring needs its key, and expired
+ * segments are dropped at the next launch.
+ * --------------------------------------------------------------------------- */
+
+/* 6 packed bytes per reading: 40 fit a persist value (256 bytes max) */
+#define JOURNAL_SEGMENT_READINGS  40
+#define JOURNAL_SEGMENTS           8
+
+/**
+ * Rebuild the history store from the journal, skipping readings older
+ * than since.  Returns false when there was nothing to load; otherwise
+ * *is_mmol is set to the units the values are in.
+ */
+bool journal_load(time_t since, bool *is_mmol);
+
+/**
+ * Append the stored readings newer than the newest journaled one, and
+ * write those older than the oldest into free segments behind it.  A
+ * change of units starts the journal over.
+ */
+void journal_sync(bool is_mmol);
+
+/** Delete the journal (e.g. when the phone reports no data). */
+void journal_clear(void);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Leveled logging
+ *
+ * LOG_ERROR .. LOG_DEBUG take APP_LOG's format and arguments.  Levels
+ * above LOG_LEVEL compile to nothing, arguments included, so a release
+ * build does no logging work on the data path.  LOG_LEVEL is set by the
+ * build (LOG_LEVEL=debug pebble build); the default keeps errors and
+ * warnings.  The benchmark probes in bench.h log on their own.
+ * --------------------------------------------------------------------------- */
+
+#define LOG_LEVEL_NONE     0
+#define LOG_LEVEL_ERROR    1
+#define LOG_LEVEL_WARNING  2
+#define LOG_LEVEL_INFO     3
+#define LOG_LEVEL_DEBUG    4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL  LOG_LEVEL_WARNING
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, args...)    APP_LOG(APP_LOG_LEVEL_ERROR, fmt, ## args)
+#else
+#define LOG_ERROR(fmt, args...)    ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(fmt, args...)  APP_LOG(APP_LOG_LEVEL_WARNING, fmt, ## args)
+#else
+#define LOG_WARNING(fmt, args...)  ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, args...)     APP_LOG(APP_LOG_LEVEL_INFO, fmt, ## args)
+#else
+#define LOG_INFO(fmt, args...)     ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, args...)    APP_LOG(APP_LOG_LEVEL_DEBUG, fmt, ## args)
+#else
+#define LOG_DEBUG(fmt, args...)    ((void)0)
+#endif
@@ -1,72 +1,189 @@
 #include <pebble.h>
+#include "axis.h"
+#include "bench.h"
+#include "energy.h"
+#include "events.h"
+#include "frame.h"
+#include "heatmap.h"
+#include "history.h"
+#include "journal.h"
+#include "log.h"
+#include "memo.h"
+#include "points.h"
+#include "power.h"
+#include "protocol.auto.h"
+#include "remote.h"
+#include "request.h"
+#include "spark.h"
+#include "stats.h"
 
 /* ---------------------------------------------------------------------------
  * Configuration constants
  * --------------------------------------------------------------------------- */
-#define MAX_READINGS      36
 #define CHART_START_X      30   /* Left margin for time labels */
 #define CHART_START_Y      10   /* Top margin for value labels */
 #define CHART_WIDTH       114   /* 144 - 30 */
-#define CHART_HEIGHT      138   /* 168 - 10 - 20; leaves 20 px at bottom for glucose-axis labels */
-#define TIME_SPACING        4   /* Pixels between readings vertically */
+#define CHART_HEIGHT      122   /* 168 - 10 - 20 - 16; leaves 20 px for glucose-axis labels and 16 for the sparkline */
+#define TIME_SPACING        3   /* Pixels per TIME_SCALE_SECONDS vertically; the plot's 118 rows hold VIEW_SECONDS */
+#define TIME_SCALE_SECONDS 300  /* Chart time scale; independent of the sample interval */
+/* Projection resolution: the view end is rounded up to this, so frames
+   within one pixel row of time render identically */
+#define SECONDS_PER_PIXEL  (TIME_SCALE_SECONDS / TIME_SPACING)
+
+/* Sample interval of the data source.  The phone reports it in every
+   header; it decimates dense (e.g. 1-minute) sources to no finer than
+   MIN_SAMPLE_INTERVAL (protocol.auto.h). */
+#define DEFAULT_SAMPLE_INTERVAL  300
 
 /* Dotted-line pattern: draw DOT_ON pixels, skip DOT_OFF pixels */
 #define DOT_ON              2
 #define DOT_OFF             3
 #define DOT_PERIOD          (DOT_ON + DOT_OFF)
 
-/* Time-grid interval in readings (6 readings = 30 minutes) */
-#define TIME_GRID_INTERVAL  6
+/* Time-grid interval in minutes */
+#define TIME_GRID_MINUTES  30
 
-/* Maximum gap between consecutive readings (in seconds) before
+/* Maximum gap between consecutive readings, in sample intervals, before
    breaking the glucose line.  Two missed 5-minute readings → 10 min. */
-#define MAX_GAP_SECONDS   600
+#define MAX_GAP_INTERVALS   2
 
 /* Padding inside the chart area so edge data points are not clipped */
 #define GRID_PADDING        2
 
+/* Extremum label box */
+#define LABEL_WIDTH        30
+#define LABEL_HEIGHT       16
+
 /* Message buffer sizes */
 #define APPMESSAGE_INBOX  2048
 #define APPMESSAGE_OUTBOX  128
 
+/* Frame budget: minimum interval between chart redraws (max 10 fps) */
+#define FRAME_BUDGET_MS     100
+
 /* Transfer timeout: reset receiving state if chunks stop arriving */
 #define TRANSFER_TIMEOUT_MS  10000
 
-/* Bytes per reading in bulk transfer */
-#define BYTES_PER_READING   6
+/* How far back the viewport may be panned: 24 hours, the phone's cache.
+   The visible window (VIEW_SECONDS), transfer sizes and packed layouts
+   come from protocol/schema.json via protocol.auto.h. */
+#define HISTORY_SECONDS   86400
+
+/* 24-hour sparkline strip, under the glucose-axis labels */
+#define SPARK_Y           (CHART_START_Y + CHART_HEIGHT + 15)
+#define SPARK_HEIGHT      (SPARK_ROWS + 2)  /* Plus the window bracket */
+
+/* Current-value header, over the oldest (top-left) corner of the chart */
+#define HEADER_X          (CHART_START_X + GRID_PADDING + 1)
+#define HEADER_Y          (CHART_START_Y + GRID_PADDING + 1)
+#define HEADER_WIDTH        72
+#define HEADER_HEIGHT       34
+
+/* Panning step per button press; a multiple of the 30-minute time grid so
+   grid lines and labels stay aligned while panned. */
+#define PAN_STEP_SECONDS  1800
+#define PAN_REPEAT_MS      150
+
+/* Scroll animation when the live view advances: one frame per pixel row
+   at the frame budget; longer jumps (e.g. after a gap) just redraw */
+#define SCROLL_MS_PER_PIXEL  FRAME_BUDGET_MS
+#define SCROLL_MAX_PIXELS    12
+/* How long a refresh tick holds the chart for the sync reply, so the
+   curve scrolls once with the new reading instead of jumping twice */
+#define SCROLL_HOLD_MS       TRANSFER_TIMEOUT_MS
+
+/* Tap/shake refresh: at most one on-demand request per this many seconds */
+#define TAP_DEBOUNCE_SECONDS  30
 
 /* ---------------------------------------------------------------------------
  * Global state
  * --------------------------------------------------------------------------- */
 static Window    *s_main_window;
 static Layer     *s_chart_layer;
-
-typedef struct {
-    int16_t value;      /* BG value x10 for mmol/L precision (e.g. 123 mg/dL = 1230) */
-    time_t  timestamp;
-} GlucoseReading;
-
-static GlucoseReading s_readings[MAX_READINGS];
-static int  s_reading_count   = 0;
+static Layer     *s_header_layer; /* Latest value, delta and age */
+static Layer     *s_debug_layer;  /* Hidden energy overlay (long-press Select) */
+
+/* Staging buffer for the transfer in progress; merged into the history
+   store only once the transfer completes. */
+static GlucoseReading s_incoming[MAX_READINGS];
+static TreatmentEvent s_incoming_events[MAX_EVENTS];
+static int  s_incoming_event_count = 0;
+static GlucoseReading s_incoming_yesterday[YESTERDAY_MAX];
+static int  s_incoming_yesterday_count = 0;
 static int  s_expected_count  = 0;
 static int  s_received_count  = 0;
 static bool s_receiving_data  = true;
 static bool s_is_mmol         = false;
 static char s_bg_units[10]    = "mg/dL";
+static int  s_sample_interval = DEFAULT_SAMPLE_INTERVAL;  /* Seconds, from the phone */
+static time_t s_last_tap_refresh = 0;  /* When a tap last asked for the newest reading */
+static time_t s_live_end = 0;  /* Live view end; moved on by update_chart() only */
+static bool s_axis_auto       = false;  /* Glucose axis fits the visible readings */
+static bool s_version_mismatch = false; /* Phone speaks another protocol version */
 static AppTimer *s_transfer_timeout_timer = NULL;
 
+/* Viewport: seconds the chart is panned back from "now" (0 = live) */
+static int  s_view_offset       = 0;
+static bool s_transfer_is_page  = false;  /* Current transfer is an older history page */
+static time_t s_transfer_page_end = 0;    /* Page transfers cover readings before this */
+
+/* Extrema of the visible readings, maintained when the visible range or
+   the store changes rather than recomputed every frame */
+static struct {
+    uint32_t generation;
+    int first;
+    int end;
+    int min_idx;   /* -1 when nothing is visible */
+    int max_idx;
+} s_extrema = { .first = -1 };
+
+/* Yesterday's trace for the live window, from the latest live transfer */
+static GlucoseReading s_yesterday[YESTERDAY_MAX];
+static int  s_yesterday_count = 0;
+static bool s_history_exhausted = false;  /* Phone has no readings older than the store */
+
+/* Scroll animation of the live view (see "Scroll animation" below) */
+static struct {
+    PropertyAnimation *animation;  /* NULL when not scrolling */
+    int16_t   offset;      /* Rows scrolled so far */
+    time_t    base_end;    /* View end of the frame held by the render memo */
+    time_t    base_head;   /* Newest reading in that frame */
+    bool      base_live;   /* That frame is a live-view chart that can scroll */
+    AppTimer *hold_timer;  /* Refresh tick waiting for the sync reply */
+} s_scroll;
+
+/* Why the chart is being redrawn; update_chart() also redraws the header
+   when the readings changed */
+typedef enum {
+    FRAME_DATA,    /* Readings changed */
+    FRAME_TIME,    /* Clock advanced */
+    FRAME_VIEW,    /* Viewport, units or render plan changed */
+    FRAME_STATUS   /* Loading / connection state changed */
+} FrameReason;
+
 /* Forward declarations */
-static void update_chart(void);
-static void request_data(void);
+static void update_chart(FrameReason reason);
+static void scroll_set_base(time_t view_end);
+static bool scroll_draw(GContext *ctx, GRect frame);
 
-/** Handle transfer timeout expiration by resetting receiving state. */
+/** Handle transfer timeout expiration by abandoning the staged transfer.
+    Readings already in the history store are kept. */
 static void transfer_timeout_callback(void *context) {
     s_transfer_timeout_timer = NULL;
+    energy_add(ENERGY_WAKEUPS, 1);
     if (s_receiving_data) {
-        APP_LOG(APP_LOG_LEVEL_WARNING, "Transfer timeout: resetting receiving state");
+        LOG_WARNING("Transfer timeout: resetting receiving state");
         s_receiving_data = false;
-        s_reading_count  = 0;
-        update_chart();
+        if (s_transfer_is_page) {
+            request_page_done();
+        } else {
+            points_clear();
+        }
+        update_chart(FRAME_STATUS);
+    } else if (remote_pending()) {
+        LOG_WARNING("Transfer timeout: no phone-rendered chart");
+        remote_clear();
+        update_chart(FRAME_DATA);
     }
 }
 
@@ -74,6 +191,18 @@ static void transfer_timeout_callback(void *context) {
  * Chart-drawing helpers
  * --------------------------------------------------------------------------- */
 
+/* One glucose trace to draw: a newest-first reading array and the range of
+   it that is visible, projected with its timestamps moved by shift. */
+typedef struct {
+    const GlucoseReading *readings;
+    int    count;
+    int    first;    /* Visible range [first, end) */
+    int    end;
+    time_t shift;    /* Seconds added to each timestamp before projection */
+    int    max_gap;  /* Longest gap (seconds) still joined by a segment */
+    bool   faint;    /* Comparison style: thin dotted line, no dots */
+} ChartSeries;
+
 /** Map a BG value to an x-pixel coordinate within the padded chart area. */
 static int bg_to_x(int bg_value, int min_bg, int bg_range) {
     int usable = CHART_WIDTH - 2 * GRID_PADDING;
@@ -81,11 +210,11 @@ static int bg_to_x(int bg_value, int min_bg, int bg_range) {
            ((bg_value - min_bg) * usable) / bg_range;
 }
 
-/** Map a timestamp to a y-pixel coordinate (now = bottom, older = higher). */
-static int timestamp_to_y(time_t ts, time_t now) {
-    int seconds_ago = (int)(now - ts);
-    /* 5 minutes (300 s) = TIME_SPACING pixels */
-    int pixel_offset = (seconds_ago * TIME_SPACING) / 300;
+/** Map a timestamp to a y-pixel coordinate (view end = bottom, older = higher). */
+static int timestamp_to_y(time_t ts, time_t view_end) {
+    int seconds_ago = (int)(view_end - ts);
+    /* TIME_SCALE_SECONDS (5 minutes) = TIME_SPACING pixels */
+    int pixel_offset = (seconds_ago * TIME_SPACING) / TIME_SCALE_SECONDS;
     return CHART_START_Y + CHART_HEIGHT - GRID_PADDING - pixel_offset;
 }
 
@@ -148,56 +277,65 @@ static void draw_dotted_hline(GContext *ctx, int y, int x_start, int x_end) {
 }
 
 /**
- * Draw a grid line label at the bottom of the chart.
+ * Draw a dotted line from a to b, continuing the dot pattern at phase so
+ * that a polyline reads as one dotted trace.  Returns the phase to pass
+ * for the next segment.
  */
-static void draw_grid_label(GContext *ctx, int bg, int min_bg, int bg_range) {
-    int x = bg_to_x(bg, min_bg, bg_range);
-    if (!x_in_bounds(x)) return;
-
-    static char label[12];
-    if (bg == 0) {
-        snprintf(label, sizeof(label), "0");
-    } else if (s_is_mmol) {
-        snprintf(label, sizeof(label), "%d.%d", bg / 10, bg % 10);
-    } else {
-        snprintf(label, sizeof(label), "%d", bg);
+static int draw_dotted_line(GContext *ctx, GPoint a, GPoint b, int phase) {
+    int dx = b.x - a.x;
+    int dy = b.y - a.y;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    for (int i = 0; i < steps; i++, phase++) {
+        if (phase % DOT_PERIOD < DOT_ON) {
+            graphics_draw_pixel(ctx, GPoint(a.x + dx * i / steps,
+                                            a.y + dy * i / steps));
+        }
     }
+    return phase;
+}
 
-    int label_y = CHART_START_Y + CHART_HEIGHT;
-    graphics_context_set_text_color(ctx, GColorBlack);
-    graphics_draw_text(ctx, label,
-                       fonts_get_system_font(FONT_KEY_GOTHIC_14),
-                       GRect(x - 15, label_y, 30, 14),
-                       GTextOverflowModeTrailingEllipsis,
-                       GTextAlignmentCenter, NULL);
+/**
+ * Draw the vertical value-reference grid lines between y_start and y_end,
+ * from the axis scale's cached lines (see axis.c).  The clinical
+ * thresholds at 4.0 mmol/L (72 mg/dL) and 10.0 mmol/L (180 mg/dL) are
+ * drawn as solid lines; the dotted lines only when draw_grid is set.
+ */
+static void draw_value_lines(GContext *ctx, const AxisScale *axis,
+                             bool draw_grid, int y_start, int y_end) {
+    for (int i = 0; i < axis->line_count; i++) {
+        const AxisLine *line = &axis->lines[i];
+        if (!x_in_bounds(line->x)) continue;
+
+        if (line->solid) {
+            draw_solid_vline(ctx, line->x, y_start, y_end);
+        } else if (draw_grid) {
+            draw_dotted_vline(ctx, line->x, y_start, y_end);
+        }
+    }
 }
 
 /**
- * Draw the vertical value-reference grid lines with labels at the bottom.
- * Uses 5 fixed values: 0, 4, 10, 15, 20 (mmol/L) or 0, 72, 180, 270, 360 (mg/dL).
- * The clinical thresholds at 4.0 mmol/L (72 mg/dL) and 10.0 mmol/L (180 mg/dL)
- * are drawn as solid lines.
+ * Draw the value grid over the full chart height, with labels at the
+ * bottom.
  */
-static void draw_value_grid(GContext *ctx, int min_bg, int bg_range) {
-    /* Fixed grid values */
-    static const int mmol_grid[] = {0, 40, 100, 150, 200};
-    static const int mgdl_grid[] = {0, 72, 180, 270, 360};
-    const int *grid = s_is_mmol ? mmol_grid : mgdl_grid;
-    int threshold_lo = s_is_mmol ?  40 :  72;  /* 4.0 mmol/L or  72 mg/dL */
-    int threshold_hi = s_is_mmol ? 100 : 180;  /* 10.0 mmol/L or 180 mg/dL */
-
-    for (int i = 0; i < 5; i++) {
-        int x = bg_to_x(grid[i], min_bg, bg_range);
-        if (!x_in_bounds(x)) continue;
-
-        if (grid[i] == threshold_lo || grid[i] == threshold_hi) {
-            draw_solid_vline(ctx, x, CHART_START_Y + GRID_PADDING,
-                             CHART_START_Y + CHART_HEIGHT - GRID_PADDING);
-        } else {
-            draw_dotted_vline(ctx, x, CHART_START_Y + GRID_PADDING,
-                              CHART_START_Y + CHART_HEIGHT - GRID_PADDING);
+static void draw_value_grid(GContext *ctx, const AxisScale *axis,
+                            bool draw_grid) {
+    GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+    int label_y = CHART_START_Y + CHART_HEIGHT;
+    graphics_context_set_text_color(ctx, GColorBlack);
+
+    draw_value_lines(ctx, axis, draw_grid, CHART_START_Y + GRID_PADDING,
+                     CHART_START_Y + CHART_HEIGHT - GRID_PADDING);
+    for (int i = 0; i < axis->line_count; i++) {
+        const AxisLine *line = &axis->lines[i];
+        if (!x_in_bounds(line->x)) continue;
+
+        if (line->labelled) {
+            graphics_draw_text(ctx, line->label, font,
+                               GRect(line->x - 15, label_y, 30, 14),
+                               GTextOverflowModeTrailingEllipsis,
+                               GTextAlignmentCenter, NULL);
         }
-        draw_grid_label(ctx, grid[i], min_bg, bg_range);
     }
 
     /* Draw glucose values axis line at the bottom of the chart area */
@@ -211,12 +349,14 @@ static void draw_value_grid(GContext *ctx, int min_bg, int bg_range) {
 
 /**
  * Draw the horizontal time-grid lines with labels on the left.
- * Lines are drawn at fixed 30-minute intervals from "now".
+ * Lines are drawn at fixed 30-minute intervals from the view end; labels
+ * count from "now", so they include the current pan offset.
+ * The dotted lines are skipped unless draw_grid is set.
  */
-static void draw_time_grid(GContext *ctx, time_t now) {
-    for (int slot = 0; slot <= MAX_READINGS; slot += TIME_GRID_INTERVAL) {
-        int minutes_ago = slot * 5;
-        int y = timestamp_to_y(now - minutes_ago * 60, now);
+static void draw_time_grid(GContext *ctx, time_t view_end, bool draw_grid) {
+    for (int minutes = 0; draw_grid && minutes <= VIEW_SECONDS / 60;
+         minutes += TIME_GRID_MINUTES) {
+        int y = timestamp_to_y(view_end - minutes * 60, view_end);
         if (y < CHART_START_Y || y > CHART_START_Y + CHART_HEIGHT) continue;
 
         /* Dotted horizontal grid line */
@@ -232,14 +372,15 @@ static void draw_time_grid(GContext *ctx, time_t now) {
                        GPoint(CHART_START_X + GRID_PADDING,
                               CHART_START_Y + CHART_HEIGHT - GRID_PADDING));
 
-    for (int slot = 0; slot <= MAX_READINGS; slot += TIME_GRID_INTERVAL) {
-        int minutes_ago = slot * 5;
-        int y = timestamp_to_y(now - minutes_ago * 60, now);
+    for (int minutes = 0; minutes <= VIEW_SECONDS / 60;
+         minutes += TIME_GRID_MINUTES) {
+        int y = timestamp_to_y(view_end - minutes * 60, view_end);
         if (y < CHART_START_Y || y > CHART_START_Y + CHART_HEIGHT) continue;
 
-        /* Time label – skip index 0 because the glucose-axis "0" already
-           occupies the bottom-left corner (origin of both axes). */
-        if (minutes_ago == 0) continue;
+        /* Time label – skip the bottom line because the glucose-axis "0"
+           already occupies the bottom-left corner (origin of both axes). */
+        if (minutes == 0) continue;
+        int minutes_ago = s_view_offset / 60 + minutes;
         static char time_label[8];
         if (minutes_ago == 30) {
             snprintf(time_label, sizeof(time_label), "30m");
@@ -258,86 +399,212 @@ static void draw_time_grid(GContext *ctx, time_t now) {
 }
 
 /**
- * Draw the glucose line graph (line segments + data-point dots).
+ * Draw the glucose traces (line segments + data-point dots).
  * Uses real timestamps for vertical positioning so gaps in readings
  * (beginning, middle, or end) are rendered correctly.
- * Line segments are omitted across gaps larger than MAX_GAP_SECONDS.
+ * Line segments are omitted across gaps longer than the series' max_gap.
+ *
+ * Only each series' visible range – found by binary search – plus one
+ * neighbour on each side (so segments run off the chart edges) is
+ * projected, however much history is stored, and every reading is
+ * projected once: each segment reuses the previous point.
+ *
+ * Series are drawn in order, so comparison traces go first, underneath.
+ * The compact style (battery saving) draws a 1 px line without dots.
  */
-static void draw_glucose_line(GContext *ctx, int min_bg, int bg_range,
-                              time_t now) {
-    graphics_context_set_stroke_color(ctx, GColorBlack);
-    graphics_context_set_stroke_width(ctx, 2);
-
-    for (int i = 0; i < s_reading_count; i++) {
-        int x = clamp_x(bg_to_x(s_readings[i].value, min_bg, bg_range));
-        int y = clamp_y(timestamp_to_y(s_readings[i].timestamp, now));
-
-        /* Draw line segment to the next (older) reading unless there is a
-           gap larger than MAX_GAP_SECONDS between them. */
-        if (i < s_reading_count - 1) {
-            int gap = (int)(s_readings[i].timestamp -
-                            s_readings[i + 1].timestamp);
-            if (gap <= MAX_GAP_SECONDS) {
-                int x2 = clamp_x(bg_to_x(s_readings[i + 1].value,
-                                          min_bg, bg_range));
-                int y2 = clamp_y(timestamp_to_y(s_readings[i + 1].timestamp, now));
-                graphics_draw_line(ctx, GPoint(x, y), GPoint(x2, y2));
+static void draw_glucose_lines(GContext *ctx, int min_bg, int bg_range,
+                               time_t view_end, const ChartSeries *series,
+                               int series_count, bool compact) {
+    for (int s = 0; s < series_count; s++) {
+        const ChartSeries *ser = &series[s];
+        if (ser->count == 0) continue;
+
+        bool dots = !compact && !ser->faint;
+        graphics_context_set_stroke_color(ctx, ser->faint ?
+            PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack) : GColorBlack);
+        graphics_context_set_stroke_width(ctx, (compact || ser->faint) ? 1 : 2);
+        graphics_context_set_fill_color(ctx, GColorBlack);
+
+        int lo = (ser->first > 0) ? ser->first - 1 : ser->first;
+        int hi = (ser->end < ser->count) ? ser->end : ser->end - 1;
+        int phase = 0;
+        GPoint prev = GPointZero;
+        time_t prev_ts = 0;
+
+        for (int i = lo; i <= hi; i++) {
+            const GlucoseReading *r = &ser->readings[i];
+            time_t ts = r->timestamp + ser->shift;
+            GPoint p = GPoint(clamp_x(bg_to_x(r->value, min_bg, bg_range)),
+                              clamp_y(timestamp_to_y(ts, view_end)));
+
+            if (i > lo) {
+                /* Segment from the newer reading unless there is a gap
+                   larger than max_gap between them */
+                if (prev_ts - ts <= ser->max_gap) {
+                    if (ser->faint) {
+                        phase = draw_dotted_line(ctx, prev, p, phase);
+                    } else {
+                        graphics_draw_line(ctx, prev, p);
+                    }
+                }
+                /* Dot for the newer reading, on top of both its segments */
+                if (dots && i - 1 >= ser->first && i - 1 < ser->end) {
+                    graphics_fill_circle(ctx, prev, 1);
+                }
             }
+            prev = p;
+            prev_ts = ts;
         }
 
-        /* Draw data-point dot (only if inside the visible chart area) */
-        if (y >= CHART_START_Y + GRID_PADDING &&
-            y <= CHART_START_Y + CHART_HEIGHT - GRID_PADDING) {
-            graphics_context_set_fill_color(ctx, GColorBlack);
-            graphics_fill_circle(ctx, GPoint(x, y), 1);
+        if (dots && hi >= ser->first && hi < ser->end) {
+            graphics_fill_circle(ctx, prev, 1);
         }
     }
 }
 
 /**
- * Draw numerical labels at the extremum (min / max) glucose points.
- *
- * Labels are placed on the "empty" side of the chart relative to the data
- * point: the min label toward lower values, the max label toward higher
- * values.
- * When the two labels are close together vertically they are pushed apart.
+ * Draw the traces from the phone's projected points: yesterday's faint
+ * trace under today's, as draw_glucose_lines() would have drawn them.
+ * Each point is joined to the one before it unless flagged POINT_BREAK,
+ * and visible readings (POINT_DOT) get a dot on top of both segments.
  */
-static void draw_extremum_labels(GContext *ctx, int min_bg, int bg_range,
-                                 time_t now) {
-    if (s_reading_count < 1) return;
-
-    int min_val = s_readings[0].value;
-    int max_val = s_readings[0].value;
-    int min_idx = 0;
-    int max_idx = 0;
-
-    for (int i = 1; i < s_reading_count; i++) {
-        if (s_readings[i].value < min_val) {
-            min_val = s_readings[i].value;
-            min_idx = i;
+static void draw_projected_lines(GContext *ctx, bool compact) {
+    static const PointsTrace order[] = { POINTS_YESTERDAY, POINTS_TODAY };
+
+    for (int s = compact ? 1 : 0; s < 2; s++) {
+        bool faint = order[s] == POINTS_YESTERDAY;
+        bool dots  = !compact && !faint;
+        int count;
+        const ChartPoint *points = points_trace(order[s], &count);
+        if (count == 0) continue;
+
+        graphics_context_set_stroke_color(ctx, faint ?
+            PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack) : GColorBlack);
+        graphics_context_set_stroke_width(ctx, (compact || faint) ? 1 : 2);
+        graphics_context_set_fill_color(ctx, GColorBlack);
+
+        int phase = 0;
+        GPoint prev = GPoint(points[0].x, points[0].y);
+        for (int i = 1; i < count; i++) {
+            GPoint p = GPoint(points[i].x, points[i].y);
+            if (!(points[i].flags & POINT_BREAK)) {
+                if (faint) {
+                    phase = draw_dotted_line(ctx, prev, p, phase);
+                } else {
+                    graphics_draw_line(ctx, prev, p);
+                }
+            }
+            if (dots && (points[i - 1].flags & POINT_DOT)) {
+                graphics_fill_circle(ctx, prev, 1);
+            }
+            prev = p;
         }
-        if (s_readings[i].value > max_val) {
-            max_val = s_readings[i].value;
-            max_idx = i;
+        if (dots && (points[count - 1].flags & POINT_DOT)) {
+            graphics_fill_circle(ctx, prev, 1);
         }
     }
+}
+
+/**
+ * Draw treatment markers along the right edge of the chart: a filled
+ * square for insulin, a ring for carbs, each at its time on the y axis.
+ * Only events in [first, end) – found by binary search – are touched, so
+ * the cost is zero when there are none on screen.  Amounts are drawn only
+ * when the battery plan allows labels.
+ */
+static void draw_event_markers(GContext *ctx, time_t view_end,
+                               int first, int end, bool draw_labels) {
+    int x = CHART_START_X + CHART_WIDTH - GRID_PADDING - 4;
+    GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
 
-    /* Format value string – mmol/L uses one decimal place */
-    static char min_label[12];
-    static char max_label[12];
+    for (int i = first; i < end; i++) {
+        const TreatmentEvent *e = events_get(i);
+        int y = timestamp_to_y(e->timestamp, view_end);
+        if (y < CHART_START_Y + GRID_PADDING ||
+            y > CHART_START_Y + CHART_HEIGHT - GRID_PADDING) {
+            continue;
+        }
 
-    if (s_is_mmol) {
-        snprintf(min_label, sizeof(min_label), "%d.%d", min_val / 10, min_val % 10);
-        snprintf(max_label, sizeof(max_label), "%d.%d", max_val / 10, max_val % 10);
-    } else {
-        snprintf(min_label, sizeof(min_label), "%d", min_val);
-        snprintf(max_label, sizeof(max_label), "%d", max_val);
+        graphics_context_set_fill_color(ctx, GColorBlack);
+        if (e->kind == EVENT_INSULIN) {
+            graphics_fill_rect(ctx, GRect(x - 3, y - 3, 7, 7), 0, GCornerNone);
+        } else {
+            graphics_fill_circle(ctx, GPoint(x, y), 4);
+            graphics_context_set_fill_color(ctx, GColorWhite);
+            graphics_fill_circle(ctx, GPoint(x, y), 2);
+        }
+
+        if (!draw_labels) continue;
+
+        static char label[8];
+        if (e->kind == EVENT_INSULIN) {
+            snprintf(label, sizeof(label), "%d.%du", e->amount / 10, e->amount % 10);
+        } else {
+            snprintf(label, sizeof(label), "%dg", e->amount);
+        }
+        GRect box = GRect(x - 36, y - 9, 30, 16);
+        graphics_context_set_text_color(ctx, GColorBlack);
+        graphics_draw_text(ctx, label, font, box,
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentRight, NULL);
     }
+}
 
+/**
+ * Draw the extremum marks for labels[0] (minimum) and labels[1] (maximum):
+ * a hollow dot at each data point, then each value in a white box.
+ */
+static void draw_extremum_marks(GContext *ctx, const ChartLabel *labels) {
     GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
 
-    int label_w = 30;
-    int label_h = 16;
+    /* Hollow dots: black fill radius 4, white fill radius 1 */
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    for (int i = 0; i < 2; i++) {
+        graphics_fill_circle(ctx, GPoint(labels[i].dot_x, labels[i].dot_y), 4);
+    }
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    for (int i = 0; i < 2; i++) {
+        graphics_fill_circle(ctx, GPoint(labels[i].dot_x, labels[i].dot_y), 1);
+    }
+
+    /* Values with a white background rectangle – mmol/L with one decimal */
+    for (int i = 0; i < 2; i++) {
+        static char label[12];
+        int value = labels[i].value;
+        if (s_is_mmol) {
+            snprintf(label, sizeof(label), "%d.%d", value / 10, value % 10);
+        } else {
+            snprintf(label, sizeof(label), "%d", value);
+        }
+        GRect box = GRect(labels[i].box_x, labels[i].box_y,
+                          LABEL_WIDTH, LABEL_HEIGHT);
+        graphics_context_set_fill_color(ctx, GColorWhite);
+        graphics_fill_rect(ctx, box, 0, GCornerNone);
+        graphics_context_set_text_color(ctx, GColorBlack);
+        graphics_draw_text(ctx, label, font, box,
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentCenter, NULL);
+    }
+}
+
+/**
+ * Draw numerical labels at the extremum (min / max) glucose points.
+ *
+ * Labels are placed on the "empty" side of the chart relative to the data
+ * point: the min label toward lower values, the max label toward higher
+ * values.
+ * When the two labels are close together vertically they are pushed apart.
+ * The extremum indices come from the maintained s_extrema.
+ */
+static void draw_extremum_labels(GContext *ctx, int min_bg, int bg_range,
+                                 time_t view_end, int min_idx, int max_idx) {
+    if (min_idx < 0) return;
+
+    int min_val = history_get(min_idx)->value;
+    int max_val = history_get(max_idx)->value;
+
+    int label_w = LABEL_WIDTH;
+    int label_h = LABEL_HEIGHT;
     int right_edge = CHART_START_X + CHART_WIDTH;
 
     /* --- helper: compute label x so label sits on the empty side --- */
@@ -348,7 +615,7 @@ static void draw_extremum_labels(GContext *ctx, int min_bg, int bg_range,
 
     /* --- minimum label position --- */
     int min_px = clamp_x(bg_to_x(min_val, min_bg, bg_range));
-    int min_py = timestamp_to_y(s_readings[min_idx].timestamp, now);
+    int min_py = timestamp_to_y(history_get(min_idx)->timestamp, view_end);
     int min_lx, min_ly;
 
     /* Place min label toward lower-value side (left) */
@@ -360,7 +627,7 @@ static void draw_extremum_labels(GContext *ctx, int min_bg, int bg_range,
 
     /* --- maximum label position --- */
     int max_px = clamp_x(bg_to_x(max_val, min_bg, bg_range));
-    int max_py = timestamp_to_y(s_readings[max_idx].timestamp, now);
+    int max_py = timestamp_to_y(history_get(max_idx)->timestamp, view_end);
     int max_lx, max_ly;
 
     /* Place max label toward higher-value side (right) */
@@ -406,34 +673,29 @@ static void draw_extremum_labels(GContext *ctx, int min_bg, int bg_range,
     if (max_ly < top_limit) max_ly = top_limit;
     if (max_ly > bot_limit) max_ly = bot_limit;
 
-    /* --- draw hollow dots at extremum points --- */
-    /* Draw hollow extremum dot: black fill radius 4, white fill radius 1 */
-    graphics_context_set_fill_color(ctx, GColorBlack);
-    graphics_fill_circle(ctx, GPoint(min_px, min_py), 4);
-    graphics_fill_circle(ctx, GPoint(max_px, max_py), 4);
-    graphics_context_set_fill_color(ctx, GColorWhite);
-    graphics_fill_circle(ctx, GPoint(min_px, min_py), 1);
-    graphics_fill_circle(ctx, GPoint(max_px, max_py), 1);
-
-    /* --- draw minimum label with white background rectangle --- */
-    graphics_context_set_fill_color(ctx, GColorWhite);
-    graphics_fill_rect(ctx, GRect(min_lx, min_ly, label_w, label_h),
-                       0, GCornerNone);
-    graphics_context_set_text_color(ctx, GColorBlack);
-    graphics_draw_text(ctx, min_label, font,
-                       GRect(min_lx, min_ly, label_w, label_h),
-                       GTextOverflowModeTrailingEllipsis,
-                       GTextAlignmentCenter, NULL);
+    ChartLabel labels[2] = {
+        { .dot_x = min_px, .dot_y = min_py, .box_x = min_lx, .box_y = min_ly,
+          .value = min_val },
+        { .dot_x = max_px, .dot_y = max_py, .box_x = max_lx, .box_y = max_ly,
+          .value = max_val }
+    };
+    draw_extremum_marks(ctx, labels);
+}
 
-    /* --- draw maximum label with white background rectangle --- */
+/**
+ * Flag the chart as out of date while the phone is unreachable, or after
+ * it failed to fetch new readings.
+ */
+static void draw_stale_badge(GContext *ctx) {
+    GRect box = GRect(CHART_START_X + CHART_WIDTH - GRID_PADDING - 50,
+                      CHART_START_Y + GRID_PADDING, 50, 16);
     graphics_context_set_fill_color(ctx, GColorWhite);
-    graphics_fill_rect(ctx, GRect(max_lx, max_ly, label_w, label_h),
-                       0, GCornerNone);
+    graphics_fill_rect(ctx, box, 0, GCornerNone);
     graphics_context_set_text_color(ctx, GColorBlack);
-    graphics_draw_text(ctx, max_label, font,
-                       GRect(max_lx, max_ly, label_w, label_h),
-                       GTextOverflowModeTrailingEllipsis,
-                       GTextAlignmentCenter, NULL);
+    graphics_draw_text(ctx, request_is_connected() ? "No sync" : "No phone",
+                       fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                       box, GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentRight, NULL);
 }
 
 /**
@@ -460,38 +722,505 @@ static void draw_no_data_message(GContext *ctx) {
  * Main chart update callback
  * --------------------------------------------------------------------------- */
 
-static void chart_layer_update_proc(Layer *layer, GContext *ctx) {
-    if (s_reading_count == 0 && s_receiving_data) {
+/**
+ * Refresh s_extrema for the visible range [first, end).  Only rescans when
+ * the range or the store has changed since the last frame.
+ */
+static void update_extrema(int first, int end) {
+    uint32_t generation = history_generation();
+    if (generation == s_extrema.generation &&
+        first == s_extrema.first && end == s_extrema.end) {
+        return;
+    }
+    s_extrema.generation = generation;
+    s_extrema.first      = first;
+    s_extrema.end        = end;
+    s_extrema.min_idx    = -1;
+    s_extrema.max_idx    = -1;
+    if (end - first < 1) return;
+
+    int min_idx = first;
+    int max_idx = first;
+    for (int i = first + 1; i < end; i++) {
+        int value = history_get(i)->value;
+        if (value < history_get(min_idx)->value) min_idx = i;
+        if (value > history_get(max_idx)->value) max_idx = i;
+    }
+    s_extrema.min_idx = min_idx;
+    s_extrema.max_idx = max_idx;
+}
+
+/**
+ * True when the live view can be drawn from the phone's projected points:
+ * no panning, and points from the latest refresh.  Like the phone-drawn
+ * bitmap they stay as projected until the next one.
+ */
+static bool points_usable(void) {
+    time_t end = points_view_end();
+    return end != 0 && s_view_offset == 0 && !s_version_mismatch &&
+           !request_is_stale() &&
+           time(NULL) - end <= power_plan()->refresh_minutes * 60 +
+                               TRANSFER_TIMEOUT_MS / 1000;
+}
+
+/** Move the live view end to now, rounded up to the projection
+    resolution so the newest reading is always inside it. */
+static void advance_live_end(void) {
+    time_t now = time(NULL);
+    s_live_end = now + (SECONDS_PER_PIXEL - now % SECONDS_PER_PIXEL) %
+                       SECONDS_PER_PIXEL;
+}
+
+/** Bottom of the viewport: the live view end as of the last chart
+    refresh, so the per-minute header frames (which redraw the whole
+    window) restore the chart from the memo instead of moving it a row;
+    with projected points, the end they were projected for. */
+static time_t chart_view_end(void) {
+    if (points_usable()) return points_view_end();
+    return s_live_end - s_view_offset;
+}
+
+/**
+ * Find the visible range [*first, *end) for view_end, refresh the extrema
+ * and fit the axis scale to them.  Returns true when the scale changed.
+ */
+static bool fit_axis(time_t view_end, int *first, int *end) {
+    /* Visible readings: newest with timestamp <= view end, through the
+       oldest with timestamp >= view start */
+    *first = history_lower_bound(view_end);
+    *end   = history_lower_bound(view_end - VIEW_SECONDS - 1);
+    update_extrema(*first, *end);
+
+    /* Fixed 0–360 mg/dL / 0–20 mmol/L axis, or auto range fitted to the
+       visible extrema; the grid is only rebuilt when the scale changes */
+    if (s_extrema.min_idx >= 0) {
+        return axis_update(s_is_mmol, s_axis_auto,
+                           history_get(s_extrema.min_idx)->value,
+                           history_get(s_extrema.max_idx)->value);
+    }
+    return axis_update(s_is_mmol, s_axis_auto, 1, 0);
+}
+
+static void draw_chart(GContext *ctx, time_t view_end) {
+    if (s_version_mismatch) {
+        graphics_context_set_text_color(ctx, GColorBlack);
+        graphics_draw_text(ctx, "Update app\non watch\nand phone",
+                           fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                           GRect(0, 50, 144, 70),
+                           GTextOverflowModeWordWrap,
+                           GTextAlignmentCenter, NULL);
+        return;
+    }
+
+    if (history_count() == 0 && s_receiving_data) {
         draw_no_data_message(ctx);
         return;
     }
 
-    /* Fixed scale: 0–20 mmol/L (internal 0–200) or 0–360 mg/dL */
-    int min_bg, bg_range;
+    /* The phone's projection comes with the axis it was projected on */
+    bool projected = points_usable();
+    int first = 0, end = 0;
+    if (projected) {
+        const ChartScale *scale = points_scale();
+        axis_set(s_is_mmol, s_axis_auto, scale->min_bg, scale->bg_range,
+                 scale->step);
+    } else {
+        fit_axis(view_end, &first, &end);
+    }
+    const AxisScale *axis = axis_scale();
+    int min_bg   = axis->min_bg;
+    int bg_range = axis->bg_range;
+
+    const PowerPlan *plan = power_plan();
+    draw_value_grid(ctx, axis, plan->draw_grid);
+
+    draw_time_grid(ctx, view_end, plan->draw_grid);
+
+    if (projected) {
+        draw_projected_lines(ctx, plan->compact);
+    } else {
+        /* Yesterday's trace under today's, skipped in the compact style */
+        time_t yesterday_end = view_end - YESTERDAY_SHIFT;
+        ChartSeries series[2] = {
+            {
+                .readings = s_yesterday,
+                .count    = plan->compact ? 0 : s_yesterday_count,
+                .first    = readings_lower_bound(s_yesterday, s_yesterday_count,
+                                                 yesterday_end),
+                .end      = readings_lower_bound(s_yesterday, s_yesterday_count,
+                                                 yesterday_end - VIEW_SECONDS - 1),
+                .shift    = YESTERDAY_SHIFT,
+                .max_gap  = MAX_GAP_INTERVALS * YESTERDAY_INTERVAL,
+                .faint    = true
+            },
+            {
+                .readings = history_readings(),
+                .count    = history_count(),
+                .first    = first,
+                .end      = end,
+                .max_gap  = MAX_GAP_INTERVALS * s_sample_interval
+            }
+        };
+        draw_glucose_lines(ctx, min_bg, bg_range, view_end, series, 2,
+                           plan->compact);
+    }
+    draw_event_markers(ctx, view_end, events_lower_bound(view_end),
+                       events_lower_bound(view_end - VIEW_SECONDS - 1),
+                       plan->draw_labels);
+    if (plan->draw_labels && projected) {
+        int count;
+        const ChartLabel *labels = points_labels(&count);
+        if (count == 2) draw_extremum_marks(ctx, labels);
+    } else if (plan->draw_labels) {
+        draw_extremum_labels(ctx, min_bg, bg_range, view_end,
+                             s_extrema.min_idx, s_extrema.max_idx);
+    }
+
+    if (request_is_stale()) {
+        draw_stale_badge(ctx);
+    }
+}
+
+/**
+ * Digest of every input draw_chart reads.  The store generation also
+ * covers events and new yesterday's traces, which only arrive alongside
+ * a merge; an empty live reply drops the trace without one, which the
+ * trace's count covers.
+ */
+static uint32_t chart_digest(Layer *layer, time_t view_end) {
+    struct {
+        uint32_t generation;
+        int32_t  view_end;
+        int32_t  view_offset;
+        int32_t  sample_interval;
+        int32_t  yesterday_count;
+        const PowerPlan *plan;
+        GRect    frame;
+        bool     is_mmol;
+        bool     axis_auto;
+        bool     receiving;
+        bool     stale;
+        bool     connected;
+        bool     mismatch;
+        bool     projected;
+    } inputs;
+    memset(&inputs, 0, sizeof(inputs));  /* Padding must hash the same */
+    inputs.generation      = history_generation();
+    inputs.view_end        = (int32_t)view_end;
+    inputs.view_offset     = s_view_offset;
+    inputs.sample_interval = s_sample_interval;
+    inputs.yesterday_count = s_yesterday_count;
+    inputs.plan            = power_plan();
+    inputs.frame           = layer_get_frame(layer);
+    inputs.is_mmol         = s_is_mmol;
+    inputs.axis_auto       = s_axis_auto;
+    inputs.receiving       = s_receiving_data;
+    inputs.stale           = request_is_stale();
+    inputs.connected       = request_is_connected();
+    inputs.mismatch        = s_version_mismatch;
+    inputs.projected       = points_usable();
+    return memo_digest(MEMO_DIGEST_INIT, &inputs, sizeof(inputs));
+}
+
+/**
+ * True when the phone-rendered bitmap can stand in for the chart: the
+ * live view with full decorations, and a bitmap from the latest refresh.
+ * Between refreshes it stays as drawn instead of moving every
+ * SECONDS_PER_PIXEL.
+ */
+static bool remote_usable(void) {
+    time_t end = remote_view_end();
+    const PowerPlan *plan = power_plan();
+    return end != 0 && s_view_offset == 0 && !s_version_mismatch &&
+           !request_is_stale() && plan->level == POWER_NORMAL &&
+           time(NULL) - end <= plan->refresh_minutes * 60 +
+                               TRANSFER_TIMEOUT_MS / 1000;
+}
+
+/**
+ * Draw the chart, or put back the previous frame when nothing it depends
+ * on has changed.  The firmware recomposites the whole window for any
+ * dirty layer (header ticks, window reveals), so most calls are repeats.
+ * The chart layer sits at the window origin, so its frame is also its
+ * framebuffer area.
+ */
+static void chart_layer_update_proc(Layer *layer, GContext *ctx) {
+    uint32_t start_ms = energy_clock_ms();
+    GRect frame = layer_get_frame(layer);
+    BenchFrameKind kind;
+
+    /* Scroll frames move the base frame; the memo keeps it until the end */
+    if (s_scroll.animation && scroll_draw(ctx, frame)) {
+        kind = BENCH_SCROLLED;
+    } else if (remote_usable() && remote_draw(ctx)) {
+        kind = BENCH_BLITTED;
+        s_scroll.base_live = false;  /* No base to scroll from in the memo */
+    } else {
+        time_t view_end = chart_view_end();
+        uint32_t digest = chart_digest(layer, view_end);
+        kind = memo_restore(ctx, frame, digest) ? BENCH_RESTORED : BENCH_DRAWN;
+        if (kind == BENCH_DRAWN) {
+            draw_chart(ctx, view_end);
+            memo_store(ctx, frame, digest);
+            scroll_set_base(view_end);
+        }
+    }
+    uint32_t render_ms = energy_clock_ms() - start_ms;
+    energy_add(ENERGY_REDRAWS, 1);
+    energy_add(ENERGY_RENDER_MS, render_ms);
+    BENCH_FRAME(render_ms, kind, history_count() > 0);
+}
+
+/**
+ * Header: latest value with the change from the previous reading, and
+ * its age.  A separate layer so the per-minute age update does not ask
+ * for a chart redraw.
+ */
+static void header_layer_update_proc(Layer *layer, GContext *ctx) {
+    if (history_count() == 0) return;
+
+    const GlucoseReading *latest = history_get(0);
+    static char value_text[20];
+    static char age_text[16];
+
+    int value = latest->value;
     if (s_is_mmol) {
-        min_bg   = 0;    /* 0.0 mmol/L */
-        bg_range = 200;  /* up to 20.0 mmol/L (internal ×10) */
+        snprintf(value_text, sizeof(value_text), "%d.%d", value / 10, value % 10);
     } else {
-        min_bg   = 0;    /* 0 mg/dL */
-        bg_range = 360;  /* up to 360 mg/dL */
+        snprintf(value_text, sizeof(value_text), "%d", value);
     }
 
-    draw_value_grid(ctx, min_bg, bg_range);
+    /* Delta only across consecutive readings (no gap in between) */
+    if (history_count() > 1 &&
+        latest->timestamp - history_get(1)->timestamp <=
+            MAX_GAP_INTERVALS * s_sample_interval) {
+        int delta = value - history_get(1)->value;
+        int mag = delta < 0 ? -delta : delta;
+        size_t len = strlen(value_text);
+        if (s_is_mmol) {
+            snprintf(value_text + len, sizeof(value_text) - len, " %c%d.%d",
+                     delta < 0 ? '-' : '+', mag / 10, mag % 10);
+        } else {
+            snprintf(value_text + len, sizeof(value_text) - len, " %c%d",
+                     delta < 0 ? '-' : '+', mag);
+        }
+    }
 
-    time_t now = time(NULL);
-    draw_time_grid(ctx, now);
-    draw_glucose_line(ctx, min_bg, bg_range, now);
-    draw_extremum_labels(ctx, min_bg, bg_range, now);
+    int minutes = (int)(time(NULL) - latest->timestamp) / 60;
+    if (minutes < 0) minutes = 0;
+    snprintf(age_text, sizeof(age_text), "%d min ago", minutes);
+
+    GRect bounds = layer_get_bounds(layer);
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+    graphics_context_set_text_color(ctx, GColorBlack);
+    graphics_draw_text(ctx, value_text,
+                       fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                       GRect(2, -2, bounds.size.w - 4, 20),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentLeft, NULL);
+    graphics_draw_text(ctx, age_text,
+                       fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                       GRect(2, 16, bounds.size.w - 4, 16),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentLeft, NULL);
+}
+
+/** Energy overlay: hourly rates on a white panel over the chart. */
+static void debug_layer_update_proc(Layer *layer, GContext *ctx) {
+    static char text[128];
+    energy_format(text, sizeof(text));
+
+    GRect bounds = layer_get_bounds(layer);
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+    graphics_context_set_stroke_color(ctx, GColorBlack);
+    graphics_draw_rect(ctx, bounds);
+    graphics_context_set_text_color(ctx, GColorBlack);
+    graphics_draw_text(ctx, text, fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                       GRect(4, 0, bounds.size.w - 8, bounds.size.h),
+                       GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+}
+
+/* ---------------------------------------------------------------------------
+ * Scroll animation
+ *
+ * When new live readings arrive the view end has moved on by a few pixel
+ * rows.  Rather than the whole curve jumping up in one frame, a short
+ * animation scrolls it: each frame moves the last full frame (kept by the
+ * render memo) up by the rows scrolled so far, redraws the grid columns
+ * across the rows that exposes at the bottom, and draws just the new
+ * readings' segments on top.  The full trace is only drawn again once,
+ * when the animation ends.  The dotted time lines ride along and settle
+ * back into place on that final frame.
+ * --------------------------------------------------------------------------- */
+
+/** Remember the frame just drawn (and stored by the memo) as the base a
+    scroll would start from. */
+static void scroll_set_base(time_t view_end) {
+    s_scroll.base_end  = view_end;
+    s_scroll.base_live = s_view_offset == 0 && !s_version_mismatch &&
+                         !request_is_stale() && history_count() > 0;
+    s_scroll.base_head = s_scroll.base_live ? history_get(0)->timestamp : 0;
+}
+
+/**
+ * One animation frame into ctx.  Returns false when the memo no longer
+ * holds the base frame, in which case the caller draws in full.
+ */
+static bool scroll_draw(GContext *ctx, GRect frame) {
+    int axis_x = CHART_START_X + GRID_PADDING;
+    int top    = CHART_START_Y + GRID_PADDING;
+    int bottom = CHART_START_Y + CHART_HEIGHT - GRID_PADDING;  /* Axis row, kept */
+    int dy     = s_scroll.offset;
+
+    /* Time labels left of the axis stay put; the plot area scrolls */
+    GRect strip = GRect(axis_x, top, frame.size.w - axis_x, bottom - top);
+    if (!memo_restore_scrolled(ctx, frame, strip, dy)) return false;
+
+    const AxisScale *axis = axis_scale();
+    const PowerPlan *plan = power_plan();
+    if (dy > 0) {
+        draw_value_lines(ctx, axis, plan->draw_grid, bottom - dy, bottom - 1);
+        draw_solid_vline(ctx, axis_x, bottom - dy, bottom - 1);
+    }
+
+    /* The readings newer than the base frame, joined to its newest one */
+    ChartSeries fresh = {
+        .readings = history_readings(),
+        .count    = history_count(),
+        .first    = 0,
+        .end      = history_lower_bound(s_scroll.base_head),
+        .max_gap  = MAX_GAP_INTERVALS * s_sample_interval
+    };
+    draw_glucose_lines(ctx, axis->min_bg, axis->bg_range,
+                       s_scroll.base_end + dy * SECONDS_PER_PIXEL,
+                       &fresh, 1, plan->compact);
+    return true;
+}
+
+static void scroll_set_offset(void *subject, int16_t offset) {
+    if (offset == s_scroll.offset) return;
+    s_scroll.offset = offset;
+    frame_request(s_chart_layer);
+}
+
+static int16_t scroll_get_offset(void *subject) {
+    return s_scroll.offset;
+}
+
+static const PropertyAnimationImplementation s_scroll_implementation = {
+    .base = {
+        .update = (AnimationUpdateImplementation)property_animation_update_int16
+    },
+    .accessors = {
+        .setter = { .int16 = scroll_set_offset },
+        .getter = { .int16 = scroll_get_offset }
+    }
+};
+
+/** Finished or cancelled: draw the real frame at the current view end. */
+static void scroll_stopped(Animation *animation, bool finished, void *context) {
+    s_scroll.animation = NULL;
+    s_scroll.offset    = 0;
+    update_chart(FRAME_DATA);
+}
+
+/**
+ * Start scrolling from the base frame to the current view end.  Returns
+ * false when that cannot be done by moving the base: it is not a live
+ * chart, nothing new arrived, the jump is too long, the axis scale
+ * changed (every column moves), the battery plan is saving power, or the
+ * phone sent the new frame ready-drawn or projected.
+ */
+static bool scroll_start(void) {
+    time_t view_end = chart_view_end();
+    int pixels = (int)(view_end - s_scroll.base_end) / SECONDS_PER_PIXEL;
+    if (s_scroll.animation || !s_scroll.base_live || s_view_offset != 0 ||
+        power_plan()->level != POWER_NORMAL ||
+        pixels <= 0 || pixels > SCROLL_MAX_PIXELS ||
+        history_lower_bound(s_scroll.base_head) == 0 ||
+        !memo_has(layer_get_frame(s_chart_layer)) || remote_usable() ||
+        points_usable()) {
+        return false;
+    }
+    int first, end;
+    if (fit_axis(view_end, &first, &end)) return false;
+
+    int16_t from = 0;
+    int16_t to   = pixels;
+    s_scroll.animation = property_animation_create(&s_scroll_implementation,
+                                                   NULL, &from, &to);
+    if (!s_scroll.animation) return false;
+
+    Animation *animation = property_animation_get_animation(s_scroll.animation);
+    animation_set_duration(animation, pixels * SCROLL_MS_PER_PIXEL);
+    animation_set_curve(animation, AnimationCurveEaseOut);
+    animation_set_handlers(animation, (AnimationHandlers){
+        .stopped = scroll_stopped
+    }, NULL);
+    s_scroll.offset = 0;
+    animation_schedule(animation);
+    return true;
+}
+
+/** Stop a running scroll (its stopped handler redraws) and any hold. */
+static void scroll_cancel(void) {
+    if (s_scroll.hold_timer) {
+        app_timer_cancel(s_scroll.hold_timer);
+        s_scroll.hold_timer = NULL;
+    }
+    if (s_scroll.animation) {
+        animation_unschedule(property_animation_get_animation(s_scroll.animation));
+    }
+}
+
+static void scroll_hold_expired(void *context) {
+    s_scroll.hold_timer = NULL;
+    update_chart(FRAME_TIME);
+}
+
+/**
+ * Refresh tick: in the live view the sync reply normally lands within
+ * seconds, so hold the chart redraw until then (or SCROLL_HOLD_MS) and
+ * let the new reading scroll in.  Elsewhere redraw now.
+ */
+static void scroll_hold(void) {
+    if (s_view_offset != 0 || request_is_stale() || s_scroll.hold_timer) {
+        if (!s_scroll.hold_timer) update_chart(FRAME_TIME);
+        return;
+    }
+    s_scroll.hold_timer = app_timer_register(SCROLL_HOLD_MS,
+                                             scroll_hold_expired, NULL);
+}
+
+/** New live readings are in: scroll to them, or redraw if that fails. */
+static void scroll_to_new_data(void) {
+    if (s_scroll.hold_timer) {
+        app_timer_cancel(s_scroll.hold_timer);
+        s_scroll.hold_timer = NULL;
+    }
+    advance_live_end();
+    if (scroll_start()) {
+        frame_request(s_header_layer);
+    } else {
+        update_chart(FRAME_DATA);
+    }
 }
 
 /* ---------------------------------------------------------------------------
  * Chart / status refresh
  * --------------------------------------------------------------------------- */
 
-/** Mark the chart layer dirty to trigger a redraw. */
-static void update_chart(void) {
-    if (s_chart_layer) {
-        layer_mark_dirty(s_chart_layer);
+/** Ask the frame scheduler to redraw the chart at the current time (and,
+    when the readings changed, the header showing the latest one). */
+static void update_chart(FrameReason reason) {
+    advance_live_end();
+    frame_request(s_chart_layer);
+    time_t view_end = s_live_end - s_view_offset;
+    spark_set_view(view_end - VIEW_SECONDS, view_end);
+    if (reason == FRAME_DATA) {
+        frame_request(s_header_layer);
     }
 }
 
@@ -499,110 +1228,445 @@ static void update_chart(void) {
  * AppMessage helpers
  * --------------------------------------------------------------------------- */
 
-/** Send an empty message to the phone to trigger a data fetch. */
-static void request_data(void) {
-    DictionaryIterator *iter;
-    app_message_outbox_begin(&iter);
-    if (iter) {
-        dict_write_uint8(iter, MESSAGE_KEY_BG_DATA, 0);
-        app_message_outbox_send();
+/**
+ * Prefetch the page above the viewport in the background once the user
+ * has panned, so the next pan step already has data to show.
+ */
+static void prefetch_history(void) {
+    int count = history_count();
+    if (s_view_offset == 0 || request_page_pending() || s_history_exhausted ||
+        count == 0 || count >= HISTORY_CAPACITY) {
+        return;
+    }
+
+    time_t view_start = chart_view_end() - VIEW_SECONDS;
+    time_t oldest = history_get(count - 1)->timestamp;
+    if (view_start - VIEW_SECONDS < oldest) {
+        request_page(oldest);
     }
 }
 
 /** Process an incoming AppMessage (units, count header, chunk, or reading). */
-static void inbox_received_callback(DictionaryIterator *iterator,
-                                     void *context) {
+static void inbox_handle(DictionaryIterator *iterator) {
     Tuple *count_tuple     = dict_find(iterator, MESSAGE_KEY_BG_COUNT);
     Tuple *units_tuple     = dict_find(iterator, MESSAGE_KEY_BG_UNITS);
     Tuple *index_tuple     = dict_find(iterator, MESSAGE_KEY_BG_INDEX);
     Tuple *chunk_tuple     = dict_find(iterator, MESSAGE_KEY_BG_CHUNK);
+    Tuple *interval_tuple  = dict_find(iterator, MESSAGE_KEY_BG_INTERVAL);
+    Tuple *events_tuple    = dict_find(iterator, MESSAGE_KEY_BG_EVENTS);
+    Tuple *yesterday_tuple = dict_find(iterator, MESSAGE_KEY_BG_YESTERDAY);
+    Tuple *axis_tuple      = dict_find(iterator, MESSAGE_KEY_BG_AXIS_AUTO);
+    Tuple *version_tuple   = dict_find(iterator, MESSAGE_KEY_PROTO_VERSION);
+
+    /* Every header carries the phone's protocol version; on a mismatch
+       nothing in it (or in chunks after it) can be trusted */
+    if (count_tuple) {
+        bool mismatch = !version_tuple ||
+                        version_tuple->value->uint16 != PROTOCOL_VERSION;
+        if (mismatch != s_version_mismatch) {
+            s_version_mismatch = mismatch;
+            update_chart(FRAME_STATUS);
+        }
+        if (mismatch) {
+            LOG_ERROR("Protocol version mismatch (watch %d)",
+                      PROTOCOL_VERSION);
+            s_expected_count = 0;
+            s_receiving_data = false;
+            return;
+        }
+    }
+    Tuple *saver_tuple     = dict_find(iterator, MESSAGE_KEY_POWER_SAVER_PCT);
+    Tuple *critical_tuple  = dict_find(iterator, MESSAGE_KEY_POWER_CRITICAL_PCT);
 
     if (units_tuple) {
         snprintf(s_bg_units, sizeof(s_bg_units), "%s",
                  units_tuple->value->cstring);
-        s_is_mmol = (strcmp(s_bg_units, "mmol/L") == 0);
+        bool is_mmol = (strcmp(s_bg_units, "mmol/L") == 0);
+        if (is_mmol != s_is_mmol && history_count() > 0) {
+            /* Stored values (journaled or paged in) are in the old units */
+            history_clear();
+        }
+        s_is_mmol = is_mmol;
+    }
+
+    /* The heatmap arrives on its own, in reply to the heatmap window */
+    Tuple *heatmap_tuple = dict_find(iterator, MESSAGE_KEY_BG_HEATMAP);
+    Tuple *start_tuple   = dict_find(iterator, MESSAGE_KEY_HEATMAP_START);
+    if (heatmap_tuple && start_tuple && version_tuple &&
+        version_tuple->value->uint16 == PROTOCOL_VERSION) {
+        static HeatmapCell cells[HEATMAP_CELLS];
+        int n = proto_decode_heatmap_cells(heatmap_tuple->value->data,
+                                           heatmap_tuple->length,
+                                           cells, HEATMAP_CELLS);
+        heatmap_update(cells, n, (time_t)start_tuple->value->uint32, s_is_mmol);
+        return;
+    }
+
+    /* The newest reading alone, in reply to a tap refresh */
+    Tuple *head_tuple = dict_find(iterator, MESSAGE_KEY_BG_HEAD);
+    if (head_tuple && version_tuple &&
+        version_tuple->value->uint16 == PROTOCOL_VERSION) {
+        GlucoseReading head;
+        if (proto_decode_readings(head_tuple->value->data, head_tuple->length,
+                                  &head, 1) != 1) {
+            return;
+        }
+        request_mark_fresh();
+        if (s_receiving_data ||
+            (history_count() > 0 && head.timestamp <= history_get(0)->timestamp)) {
+            return;
+        }
+        history_merge(&head, 1);
+        journal_sync(s_is_mmol);
+        /* The phone's chart or points predate the reading: draw it here
+           until the next sync brings fresh ones */
+        remote_clear();
+        points_clear();
+        scroll_to_new_data();
+        return;
+    }
+
+    Tuple *stats_tuple = dict_find(iterator, MESSAGE_KEY_BG_STATS);
+    if (stats_tuple) {
+        StatsWindow windows[STATS_WINDOWS];
+        int n = proto_decode_stats_windows(stats_tuple->value->data,
+                                           stats_tuple->length,
+                                           windows, STATS_WINDOWS);
+        stats_update(windows, n, s_is_mmol);
+    }
+
+    Tuple *spark_tuple     = dict_find(iterator, MESSAGE_KEY_BG_SPARK);
+    Tuple *spark_end_tuple = dict_find(iterator, MESSAGE_KEY_SPARK_END);
+    if (spark_tuple && spark_end_tuple) {
+        SparkColumn columns[SPARK_COLUMNS];
+        int n = proto_decode_spark_columns(spark_tuple->value->data,
+                                           spark_tuple->length,
+                                           columns, SPARK_COLUMNS);
+        spark_update(columns, n, (time_t)spark_end_tuple->value->uint32);
+    }
+
+    if (axis_tuple && (axis_tuple->value->int32 != 0) != s_axis_auto) {
+        s_axis_auto = axis_tuple->value->int32 != 0;
+        update_chart(FRAME_VIEW);
+    }
+
+    if (interval_tuple && interval_tuple->value->int32 >= MIN_SAMPLE_INTERVAL) {
+        s_sample_interval = interval_tuple->value->int32;
+    }
+
+    if (saver_tuple && critical_tuple) {
+        power_set_thresholds(saver_tuple->value->int32,
+                             critical_tuple->value->int32);
     }
 
     if (count_tuple) {
+        /* A page-end key marks the reply to a history page request */
+        Tuple *page_end_tuple = dict_find(iterator, MESSAGE_KEY_BG_PAGE_END);
+        bool is_page = page_end_tuple != NULL;
         int count = count_tuple->value->int32;
         if (count == 0) {
-            /* Phone signalled no data available */
+            /* Phone signalled no data: a failed fetch keeps everything
+               stored, an empty live window keeps the older readings, and
+               only a phone holding no readings at all clears the store */
+            Tuple *status_tuple = dict_find(iterator, MESSAGE_KEY_BG_STATUS);
+            int status = status_tuple ? status_tuple->value->uint8 : 0;
             if (s_transfer_timeout_timer) {
                 app_timer_cancel(s_transfer_timeout_timer);
                 s_transfer_timeout_timer = NULL;
             }
             s_receiving_data = false;
-            s_reading_count  = 0;
-            update_chart();
+            if (is_page && status == BG_STATUS_FAILED) {
+                request_page_failed();
+                return;
+            }
+            if (is_page) {
+                /* Nothing older on the phone */
+                request_page_done();
+                s_history_exhausted = true;
+                return;
+            }
+            if (status == BG_STATUS_FAILED) {
+                request_mark_failed();
+                return;
+            }
+            request_mark_fresh();
+            remote_clear();
+            points_clear();
+            s_yesterday_count = 0;
+            if (status == BG_STATUS_EMPTY) {
+                history_clear();
+                journal_clear();
+                events_clear();
+                s_history_exhausted = false;
+            }
+            update_chart(FRAME_DATA);
             return;
         }
         if (count > MAX_READINGS) count = MAX_READINGS;
-        s_expected_count = count;
-        s_received_count = 0;
-        s_receiving_data = true;
-        memset(s_readings, 0, sizeof(s_readings));
+        s_expected_count   = count;
+        s_received_count   = 0;
+        s_receiving_data   = true;
+        s_transfer_is_page = is_page;
+        s_transfer_page_end = is_page ? (time_t)page_end_tuple->value->int32 : 0;
+        memset(s_incoming, 0, sizeof(s_incoming));
+
+        /* Treatment events for the transfer's time range ride in the header */
+        s_incoming_event_count = !events_tuple ? 0 :
+            proto_decode_events(events_tuple->value->data, events_tuple->length,
+                                s_incoming_events, MAX_EVENTS);
+
+        /* So does yesterday's trace, on live transfers */
+        s_incoming_yesterday_count = !yesterday_tuple ? 0 :
+            proto_decode_readings(yesterday_tuple->value->data,
+                                  yesterday_tuple->length,
+                                  s_incoming_yesterday, YESTERDAY_MAX);
         if (s_transfer_timeout_timer) {
             app_timer_cancel(s_transfer_timeout_timer);
         }
         s_transfer_timeout_timer = app_timer_register(TRANSFER_TIMEOUT_MS,
                                                        transfer_timeout_callback, NULL);
+
+        /* A live transfer may announce the phone-rendered chart after it */
+        if (!is_page) {
+            Tuple *size_tuple = dict_find(iterator, MESSAGE_KEY_CHART_SIZE);
+            Tuple *end_tuple  = dict_find(iterator, MESSAGE_KEY_CHART_END);
+            if (size_tuple && end_tuple) {
+                remote_begin(size_tuple->value->uint16,
+                             (time_t)end_tuple->value->uint32);
+            } else {
+                remote_clear();
+            }
+
+            /* ...or carry the chart projected for this screen */
+            Tuple *points_end_tuple = dict_find(iterator, MESSAGE_KEY_POINTS_END);
+            Tuple *scale_tuple      = dict_find(iterator, MESSAGE_KEY_POINTS_AXIS);
+            Tuple *points_tuple     = dict_find(iterator, MESSAGE_KEY_BG_POINTS);
+            ChartScale scale;
+            if (points_end_tuple && points_tuple && scale_tuple &&
+                proto_decode_chart_scales(scale_tuple->value->data,
+                                          scale_tuple->length, &scale, 1) == 1) {
+                Tuple *faint_tuple  = dict_find(iterator, MESSAGE_KEY_BG_YESTERDAY_POINTS);
+                Tuple *labels_tuple = dict_find(iterator, MESSAGE_KEY_BG_LABELS);
+                points_begin((time_t)points_end_tuple->value->uint32, &scale);
+                points_set_trace(POINTS_TODAY, points_tuple->value->data,
+                                 points_tuple->length);
+                if (faint_tuple) {
+                    points_set_trace(POINTS_YESTERDAY, faint_tuple->value->data,
+                                     faint_tuple->length);
+                }
+                if (labels_tuple) {
+                    points_set_labels(labels_tuple->value->data,
+                                      labels_tuple->length);
+                }
+            } else {
+                points_clear();
+            }
+        }
+        return;
+    }
+
+    /* Phone-rendered chart chunks, once the readings are in */
+    Tuple *rle_tuple    = dict_find(iterator, MESSAGE_KEY_CHART_RLE);
+    Tuple *offset_tuple = dict_find(iterator, MESSAGE_KEY_CHART_OFFSET);
+    if (rle_tuple && offset_tuple) {
+        if (!remote_pending()) return;
+        remote_receive(offset_tuple->value->uint16, rle_tuple->value->data,
+                       rle_tuple->length);
+        if (remote_pending() || s_receiving_data) return;
+
+        /* Complete, or dropped as malformed: either way the transfer is */
+        if (s_transfer_timeout_timer) {
+            app_timer_cancel(s_transfer_timeout_timer);
+            s_transfer_timeout_timer = NULL;
+        }
+        scroll_to_new_data();
         return;
     }
 
     /* Bulk chunk path */
     if (chunk_tuple && index_tuple) {
-        uint8_t *data = chunk_tuple->value->data;
-        int byte_len = chunk_tuple->length;
         int start_index = index_tuple->value->int32;
-        int readings_in_chunk = byte_len / BYTES_PER_READING;
-
-        for (int i = 0; i < readings_in_chunk; i++) {
-            int idx = start_index + i;
-            if (idx >= MAX_READINGS) break;
-            int offset = i * BYTES_PER_READING;
-            s_readings[idx].value = (int16_t)(data[offset] | (data[offset + 1] << 8));
-            s_readings[idx].timestamp = (time_t)((uint32_t)data[offset + 2] |
-                                                  ((uint32_t)data[offset + 3] << 8) |
-                                                  ((uint32_t)data[offset + 4] << 16) |
-                                                  ((uint32_t)data[offset + 5] << 24));
-            s_received_count++;
-        }
+        if (start_index < 0 || start_index >= s_expected_count) return;
+
+        s_received_count += proto_decode_readings(chunk_tuple->value->data,
+                                                  chunk_tuple->length,
+                                                  &s_incoming[start_index],
+                                                  s_expected_count - start_index);
 
         if (s_received_count >= s_expected_count) {
-            if (s_transfer_timeout_timer) {
+            if (s_transfer_timeout_timer && !remote_pending()) {
                 app_timer_cancel(s_transfer_timeout_timer);
                 s_transfer_timeout_timer = NULL;
             }
-            s_reading_count  = s_expected_count;
+            history_merge(s_incoming, s_expected_count);
+
+            /* The transfer is authoritative for events from its oldest
+               reading up to the page end (or onwards, for live data) */
+            time_t events_end = s_transfer_is_page ? s_transfer_page_end - 1
+                                                   : (time_t)INT32_MAX;
+            events_replace(s_incoming[s_expected_count - 1].timestamp, events_end,
+                           s_incoming_events, s_incoming_event_count);
+            journal_sync(s_is_mmol);
+            if (!s_transfer_is_page) {
+                memcpy(s_yesterday, s_incoming_yesterday,
+                       s_incoming_yesterday_count * sizeof(GlucoseReading));
+                s_yesterday_count = s_incoming_yesterday_count;
+            }
             s_receiving_data = false;
-            update_chart();
+            if (s_transfer_is_page) {
+                request_page_done();
+                prefetch_history();
+                update_chart(FRAME_DATA);
+            } else {
+                request_mark_fresh();
+                /* With the phone-rendered chart still to come, wait for it */
+                if (!remote_pending()) scroll_to_new_data();
+            }
         }
         return;
     }
 }
 
+static void inbox_received_callback(DictionaryIterator *iterator,
+                                     void *context) {
+    uint32_t start_ms = energy_clock_ms();
+    size_t bytes = dict_size(iterator);
+    energy_add(ENERGY_INBOX_MSGS, 1);
+    energy_add(ENERGY_INBOX_BYTES, bytes);
+    BENCH_SAMPLE();
+    inbox_handle(iterator);
+    BENCH_INBOX(start_ms, bytes);
+}
+
 static void inbox_dropped_callback(AppMessageResult reason, void *context) {
-    APP_LOG(APP_LOG_LEVEL_ERROR, "Message dropped: %d", reason);
+    LOG_ERROR("Message dropped: %d", reason);
+}
+
+/** Redraw when the phone connection drops or data becomes fresh again. */
+static void stale_changed(bool stale) {
+    update_chart(FRAME_STATUS);
 }
 
-static void outbox_failed_callback(DictionaryIterator *iterator,
-                                    AppMessageResult reason,
-                                    void *context) {
-    APP_LOG(APP_LOG_LEVEL_ERROR, "Message send failed: %d", reason);
+/** Redraw with the decorations the new battery plan allows. */
+static void power_plan_changed(const PowerPlan *plan) {
+    update_chart(FRAME_VIEW);
 }
 
 /* ---------------------------------------------------------------------------
  * Timer
  * --------------------------------------------------------------------------- */
 
-/** Tick handler – refresh every 5 minutes for battery efficiency. */
+/** Tick handler – age the header every minute; refresh the chart at the
+    battery plan's interval (5 minutes when the charge is healthy, longer
+    when it runs low). */
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-    if (tick_time->tm_min % 5 == 0) {
-        update_chart();
-        request_data();
+    energy_add(ENERGY_WAKEUPS, 1);
+    if (history_count() > 0) {
+        frame_request(s_header_layer);
+    }
+    if (!layer_get_hidden(s_debug_layer)) {
+        frame_request(s_debug_layer);
+    }
+    if (tick_time->tm_min % power_plan()->refresh_minutes == 0) {
+        request_sync();
+        scroll_hold();
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * Tap / shake – on-demand refresh
+ * --------------------------------------------------------------------------- */
+
+/** Ask the phone for the newest reading now rather than at the next
+    refresh tick; debounced, and skipped while no newer reading can exist
+    yet (the newest is younger than the sample interval). */
+static void tap_handler(AccelAxisType axis, int32_t direction) {
+    energy_add(ENERGY_WAKEUPS, 1);
+    time_t now = time(NULL);
+    if (now - s_last_tap_refresh < TAP_DEBOUNCE_SECONDS || !request_is_connected()) {
+        return;
+    }
+    if (history_count() > 0 &&
+        now - history_get(0)->timestamp < s_sample_interval) {
+        return;
+    }
+    s_last_tap_refresh = now;
+    LOG_DEBUG("Tap refresh");
+    request_head();
+    scroll_hold();
+}
+
+/* ---------------------------------------------------------------------------
+ * Buttons – history panning
+ * --------------------------------------------------------------------------- */
+
+/** Move the viewport by delta seconds (positive = further back in time). */
+static void pan_view(int delta) {
+    int offset = s_view_offset + delta;
+    if (offset < 0) offset = 0;
+    if (offset > HISTORY_SECONDS - VIEW_SECONDS) {
+        offset = HISTORY_SECONDS - VIEW_SECONDS;
+    }
+
+    /* Stop panning back once the oldest reading is on screen and the
+       phone has nothing older to offer. */
+    if (delta > 0) {
+        int count = history_count();
+        bool more_coming = !s_history_exhausted && count > 0 &&
+                           count < HISTORY_CAPACITY;
+        time_t view_start = chart_view_end() - VIEW_SECONDS;
+        if (count == 0 ||
+            (!more_coming && history_get(count - 1)->timestamp >= view_start)) {
+            return;
+        }
+    }
+
+    if (offset == s_view_offset) return;
+    scroll_cancel();
+    s_view_offset = offset;
+    prefetch_history();
+    update_chart(FRAME_VIEW);
+}
+
+static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
+    pan_view(PAN_STEP_SECONDS);
+}
+
+static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
+    pan_view(-PAN_STEP_SECONDS);
+}
+
+/** Select jumps straight back to the live view; in the live view it opens
+    the statistics page. */
+static void select_click_handler(ClickRecognizerRef recognizer, void *context) {
+    if (s_view_offset == 0) {
+        stats_window_push();
+        return;
+    }
+    pan_view(-s_view_offset);
+}
+
+/** Long-press Select toggles the energy overlay; showing it also sends
+    the counters to the phone log. */
+static void select_long_click_handler(ClickRecognizerRef recognizer,
+                                      void *context) {
+    bool show = layer_get_hidden(s_debug_layer);
+    layer_set_hidden(s_debug_layer, !show);
+    if (show) {
+        request_report();
+    }
+}
+
+static void click_config_provider(void *context) {
+    window_single_repeating_click_subscribe(BUTTON_ID_UP, PAN_REPEAT_MS,
+                                            up_click_handler);
+    window_single_repeating_click_subscribe(BUTTON_ID_DOWN, PAN_REPEAT_MS,
+                                            down_click_handler);
+    window_single_click_subscribe(BUTTON_ID_SELECT, select_click_handler);
+    window_long_click_subscribe(BUTTON_ID_SELECT, 0,
+                                select_long_click_handler, NULL);
+}
+
 /* ---------------------------------------------------------------------------
  * Window lifecycle
  * --------------------------------------------------------------------------- */
@@ -614,9 +1678,26 @@ static void main_window_load(Window *window) {
     s_chart_layer = layer_create(GRect(0, 0, bounds.size.w, bounds.size.h));
     layer_set_update_proc(s_chart_layer, chart_layer_update_proc);
     layer_add_child(window_layer, s_chart_layer);
+
+    layer_add_child(window_layer, spark_create(GRect(0, SPARK_Y,
+                                                     CHART_START_X + CHART_WIDTH,
+                                                     SPARK_HEIGHT)));
+
+    s_header_layer = layer_create(GRect(HEADER_X, HEADER_Y,
+                                        HEADER_WIDTH, HEADER_HEIGHT));
+    layer_set_update_proc(s_header_layer, header_layer_update_proc);
+    layer_add_child(window_layer, s_header_layer);
+
+    s_debug_layer = layer_create(GRect(10, 30, bounds.size.w - 20, 96));
+    layer_set_update_proc(s_debug_layer, debug_layer_update_proc);
+    layer_set_hidden(s_debug_layer, true);
+    layer_add_child(window_layer, s_debug_layer);
 }
 
 static void main_window_unload(Window *window) {
+    layer_destroy(s_debug_layer);
+    layer_destroy(s_header_layer);
+    spark_destroy();
     layer_destroy(s_chart_layer);
 }
 
@@ -625,24 +1706,57 @@ static void main_window_unload(Window *window) {
  * --------------------------------------------------------------------------- */
 
 static void init(void) {
+    BENCH_INIT();
+    energy_init();
+    axis_init(CHART_START_X + GRID_PADDING, CHART_WIDTH - 2 * GRID_PADDING);
+    frame_init(FRAME_BUDGET_MS);
+    power_init(power_plan_changed);
+
+    /* Show the journaled history while the first sync is under way */
+    bool is_mmol;
+    advance_live_end();
+    if (journal_load(time(NULL) - HISTORY_SECONDS, &is_mmol)) {
+        s_is_mmol = is_mmol;
+        snprintf(s_bg_units, sizeof(s_bg_units), "%s",
+                 is_mmol ? "mmol/L" : "mg/dL");
+    }
+
     s_main_window = window_create();
     window_set_background_color(s_main_window, GColorWhite);
     window_set_window_handlers(s_main_window, (WindowHandlers){
         .load   = main_window_load,
         .unload = main_window_unload
     });
+    window_set_click_config_provider(s_main_window, click_config_provider);
     window_stack_push(s_main_window, true);
 
     app_message_register_inbox_received(inbox_received_callback);
     app_message_register_inbox_dropped(inbox_dropped_callback);
-    app_message_register_outbox_failed(outbox_failed_callback);
+    request_init(stale_changed);
+    static const ChartLayout layout = {
+        .chart_x = CHART_START_X, .chart_y = CHART_START_Y,
+        .chart_w = CHART_WIDTH,   .chart_h = CHART_HEIGHT,
+        .padding = GRID_PADDING,  .seconds_per_pixel = SECONDS_PER_PIXEL,
+        .label_w = LABEL_WIDTH,   .label_h = LABEL_HEIGHT
+    };
+    request_set_layout(&layout);
     app_message_open(APPMESSAGE_INBOX, APPMESSAGE_OUTBOX);
 
     tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
-    request_data();
+    accel_tap_service_subscribe(tap_handler);
+    request_sync();
 }
 
 static void deinit(void) {
+    accel_tap_service_unsubscribe();
+    scroll_cancel();
+    request_deinit();
+    power_deinit();
+    frame_deinit();
+    heatmap_deinit();
+    stats_deinit();
+    memo_deinit();
+    remote_deinit();
     window_destroy(s_main_window);
 }
 
@@ -0,0 +1,164 @@
+#include "memo.h"
+#include "log.h"
+
+static uint8_t *s_copy   = NULL;
+static size_t   s_size   = 0;
+static uint32_t s_digest = 0;
+static GRect    s_rect;
+static bool     s_valid  = false;
+static bool     s_disabled = false;  /* The copy did not fit in the heap */
+
+uint32_t memo_digest(uint32_t digest, const void *data, size_t size) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < size; i++) {
+        digest = (digest ^ p[i]) * 16777619u;
+    }
+    return digest;
+}
+
+/** Bytes of framebuffer row y to copy, and where they start. */
+static size_t row_span(GBitmap *fb, int y, uint8_t **start) {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    if (gbitmap_get_format(fb) == GBitmapFormat1Bit) {
+        *start = info.data;
+        return gbitmap_get_bytes_per_row(fb);
+    }
+    /* 8-bit rows; on round displays only min_x..max_x exist */
+    *start = info.data + info.min_x;
+    return info.max_x - info.min_x + 1;
+}
+
+/** Copy the rows of rect between the framebuffer and s_copy. */
+static size_t copy_rows(GBitmap *fb, GRect rect, bool to_framebuffer) {
+    size_t offset = 0;
+    for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+        uint8_t *row;
+        size_t bytes = row_span(fb, y, &row);
+        if (to_framebuffer) {
+            memcpy(row, s_copy + offset, bytes);
+        } else if (s_copy) {
+            memcpy(s_copy + offset, row, bytes);
+        }
+        offset += bytes;
+    }
+    return offset;
+}
+
+bool memo_restore(GContext *ctx, GRect rect, uint32_t digest) {
+    if (!s_valid || digest != s_digest || !grect_equal(&rect, &s_rect)) {
+        return false;
+    }
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+    copy_rows(fb, rect, true);
+    graphics_release_frame_buffer(ctx, fb);
+    return true;
+}
+
+/**
+ * Move the strip columns of row y: from the copy of row src_y (at
+ * src_offset), or to white once src_y has run past the strip.
+ */
+static void scroll_row(GBitmap *fb, uint8_t *row, int y, int src_y,
+                       size_t src_offset, GRect strip) {
+    bool exposed = src_y >= strip.origin.y + strip.size.h;
+    if (gbitmap_get_format(fb) == GBitmapFormat1Bit) {
+        int bytes = gbitmap_get_bytes_per_row(fb);
+        int c0 = strip.origin.x / 8;
+        int c1 = (strip.origin.x + strip.size.w + 7) / 8;
+        if (c1 > bytes) c1 = bytes;
+        if (c1 <= c0) return;
+        if (exposed) {
+            memset(row + c0, 0xFF, c1 - c0);  /* Set bits are white */
+        } else {
+            memcpy(row + c0, s_copy + src_offset + c0, c1 - c0);
+        }
+        return;
+    }
+
+    /* 8-bit rows hold min_x..max_x, which differ between rows on round
+       displays: move only the columns both rows have */
+    GBitmapDataRowInfo dst = gbitmap_get_data_row_info(fb, y);
+    int x0 = strip.origin.x > dst.min_x ? strip.origin.x : dst.min_x;
+    int x1 = strip.origin.x + strip.size.w - 1;
+    if (x1 > dst.max_x) x1 = dst.max_x;
+    if (exposed) {
+        if (x1 >= x0) memset(row + (x0 - dst.min_x), 0xFF, x1 - x0 + 1);
+        return;
+    }
+    GBitmapDataRowInfo src = gbitmap_get_data_row_info(fb, src_y);
+    if (x0 < src.min_x) x0 = src.min_x;
+    if (x1 > src.max_x) x1 = src.max_x;
+    if (x1 >= x0) {
+        memcpy(row + (x0 - dst.min_x), s_copy + src_offset + (x0 - src.min_x),
+               x1 - x0 + 1);
+    }
+}
+
+bool memo_restore_scrolled(GContext *ctx, GRect rect, GRect strip, int dy) {
+    if (!memo_has(rect)) return false;
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return false;
+
+    int strip_end = strip.origin.y + strip.size.h;
+    size_t offset = 0;      /* Copy offset of row y */
+    size_t src_offset = 0;  /* ...and of row src_y, dy rows further down */
+    int src_y = rect.origin.y;
+    for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+        uint8_t *row;
+        size_t bytes = row_span(fb, y, &row);
+        memcpy(row, s_copy + offset, bytes);
+        offset += bytes;
+
+        if (y < strip.origin.y || y >= strip_end) continue;
+        while (src_y < y + dy && src_y < strip_end) {
+            uint8_t *unused;
+            src_offset += row_span(fb, src_y, &unused);
+            src_y++;
+        }
+        scroll_row(fb, row, y, y + dy, src_offset, strip);
+    }
+    graphics_release_frame_buffer(ctx, fb);
+    return true;
+}
+
+bool memo_has(GRect rect) {
+    return s_valid && grect_equal(&rect, &s_rect);
+}
+
+void memo_store(GContext *ctx, GRect rect, uint32_t digest) {
+    s_valid = false;
+    if (s_disabled) return;
+    GBitmap *fb = graphics_capture_frame_buffer(ctx);
+    if (!fb) return;
+
+    /* Size the copy on first use (and if the rows ever change) */
+    if (!s_copy || !grect_equal(&rect, &s_rect)) {
+        free(s_copy);
+        s_copy = NULL;
+        s_size = copy_rows(fb, rect, false);
+        s_copy = malloc(s_size);
+        if (!s_copy) {
+            s_disabled = true;
+            LOG_WARNING("Render memo disabled (%d bytes)",
+                        (int)s_size);
+        }
+    }
+    if (s_copy) {
+        copy_rows(fb, rect, false);
+        s_rect   = rect;
+        s_digest = digest;
+        s_valid  = true;
+    }
+    graphics_release_frame_buffer(ctx, fb);
+}
+
+void memo_invalidate(void) {
+    s_valid = false;
+}
+
+void memo_deinit(void) {
+    free(s_copy);
+    s_copy  = NULL;
+    s_valid = false;
+}
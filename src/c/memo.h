@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Render memo
+ *
+ * Keeps a copy of the framebuffer rows a layer drew last, keyed by a digest
+ * of everything that drawing depended on.  When a later frame has the same
+ * digest (a header-only frame, a window reveal) the copy is put back
+ * instead of drawing again.  The copy is allocated on first use; if the
+ * heap cannot spare it, every frame is simply drawn.
+ * --------------------------------------------------------------------------- */
+
+/** Starting value for memo_digest (FNV-1a offset basis). */
+#define MEMO_DIGEST_INIT  2166136261u
+
+/** Fold size bytes at data into digest (FNV-1a). */
+uint32_t memo_digest(uint32_t digest, const void *data, size_t size);
+
+/**
+ * If the stored copy has this digest and covers the same rows, write it
+ * into the framebuffer and return true; the caller then skips drawing.
+ */
+bool memo_restore(GContext *ctx, GRect rect, uint32_t digest);
+
+/**
+ * Put back the stored copy of rect with the pixels inside strip moved up
+ * by dy rows, as if that part had scrolled; the dy rows this exposes at
+ * the bottom of strip are cleared to white.  On 1-bit displays strip's
+ * left edge is taken down to a whole byte.  Returns false, touching
+ * nothing, when no copy of rect is stored.
+ */
+bool memo_restore_scrolled(GContext *ctx, GRect rect, GRect strip, int dy);
+
+/** True when a copy of rect is stored (whatever its digest). */
+bool memo_has(GRect rect);
+
+/** Copy the framebuffer rows spanned by rect, keyed by digest. */
+void memo_store(GContext *ctx, GRect rect, uint32_t digest);
+
+/** Forget the stored copy (e.g. before drawing over it with other content). */
+void memo_invalidate(void);
+
+/** Free the stored copy. */
+void memo_deinit(void);
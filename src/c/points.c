@@ -0,0 +1,51 @@
+#include "points.h"
+
+#define LABELS_MAX  2
+
+static ChartPoint s_points[POINTS_TRACES][POINTS_MAX];
+static int        s_counts[POINTS_TRACES];
+static ChartLabel s_labels[LABELS_MAX];
+static int        s_label_count = 0;
+static ChartScale s_scale;
+static time_t     s_view_end    = 0;
+
+void points_begin(time_t view_end, const ChartScale *scale) {
+    memset(s_counts, 0, sizeof(s_counts));
+    s_label_count = 0;
+    s_scale       = *scale;
+    s_view_end    = view_end;
+}
+
+void points_set_trace(PointsTrace trace, const uint8_t *data, int length) {
+    s_counts[trace] = proto_decode_chart_points(data, length,
+                                                s_points[trace], POINTS_MAX);
+}
+
+void points_set_labels(const uint8_t *data, int length) {
+    s_label_count = proto_decode_chart_labels(data, length, s_labels, LABELS_MAX);
+    if (s_label_count != LABELS_MAX) s_label_count = 0;
+}
+
+time_t points_view_end(void) {
+    return s_view_end;
+}
+
+const ChartScale *points_scale(void) {
+    return &s_scale;
+}
+
+const ChartPoint *points_trace(PointsTrace trace, int *count) {
+    *count = s_counts[trace];
+    return s_points[trace];
+}
+
+const ChartLabel *points_labels(int *count) {
+    *count = s_label_count;
+    return s_labels;
+}
+
+void points_clear(void) {
+    memset(s_counts, 0, sizeof(s_counts));
+    s_label_count = 0;
+    s_view_end    = 0;
+}
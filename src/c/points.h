@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * Projected chart points
+ *
+ * In the projected-points mode (a setting on the phone) a live header
+ * carries the chart already mapped to this watch's screen, using the
+ * geometry the watch sends with each sync: the axis it was projected on,
+ * uint8 x/y per point of today's and yesterday's traces with segment-break
+ * and dot flags, and the extremum label anchors.  Drawing from these needs
+ * no projection, division or gap logic.  The points stay as projected
+ * until the next refresh replaces them; panned views are drawn from the
+ * readings as before.
+ * --------------------------------------------------------------------------- */
+
+typedef enum {
+    POINTS_TODAY = 0,
+    POINTS_YESTERDAY,
+    POINTS_TRACES
+} PointsTrace;
+
+/** Start a projection for view_end on scale, with no points yet. */
+void points_begin(time_t view_end, const ChartScale *scale);
+
+/** Decode a trace's packed ChartPoints (newest first) into the projection. */
+void points_set_trace(PointsTrace trace, const uint8_t *data, int length);
+
+/** Decode the packed extremum labels (minimum, then maximum). */
+void points_set_labels(const uint8_t *data, int length);
+
+/** The view end the projection is for; 0 when there is none. */
+time_t points_view_end(void);
+
+/** The axis the points were projected on. */
+const ChartScale *points_scale(void);
+
+/** A trace's points; *count is set to their number. */
+const ChartPoint *points_trace(PointsTrace trace, int *count);
+
+/** The extremum labels; *count is set to their number (0 or 2). */
+const ChartLabel *points_labels(int *count);
+
+/** Drop the projection (e.g. when a transfer without one replaces the data). */
+void points_clear(void);
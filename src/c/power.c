@@ -0,0 +1,78 @@
+#include "power.h"
+#include "log.h"
+
+/* Persist keys owned by this module */
+#define PERSIST_KEY_SAVER_PCT     1
+#define PERSIST_KEY_CRITICAL_PCT  2
+
+#define DEFAULT_SAVER_PCT        30
+#define DEFAULT_CRITICAL_PCT     10
+
+static const PowerPlan s_plans[] = {
+    /*                level           refresh grid   labels compact */
+    [POWER_NORMAL]   = { POWER_NORMAL,    5,   true,  true,  false },
+    [POWER_SAVER]    = { POWER_SAVER,    10,   false, false, false },
+    [POWER_CRITICAL] = { POWER_CRITICAL, 15,   false, false, true  },
+};
+
+static int        s_saver_pct    = DEFAULT_SAVER_PCT;
+static int        s_critical_pct = DEFAULT_CRITICAL_PCT;
+static PowerLevel s_level        = POWER_NORMAL;
+static PowerPlanHandler s_handler = NULL;
+
+static PowerLevel level_for(BatteryChargeState state) {
+    if (state.is_charging || state.is_plugged) return POWER_NORMAL;
+    if (state.charge_percent <= s_critical_pct) return POWER_CRITICAL;
+    if (state.charge_percent <= s_saver_pct)    return POWER_SAVER;
+    return POWER_NORMAL;
+}
+
+/** Re-evaluate the plan and notify the handler if it changed. */
+static void apply(BatteryChargeState state) {
+    PowerLevel level = level_for(state);
+    if (level == s_level) return;
+
+    s_level = level;
+    LOG_INFO("Power plan %d at %d%%",
+             (int)level, (int)state.charge_percent);
+    if (s_handler) {
+        s_handler(&s_plans[level]);
+    }
+}
+
+static void battery_handler(BatteryChargeState state) {
+    apply(state);
+}
+
+void power_init(PowerPlanHandler handler) {
+    s_handler = handler;
+    if (persist_exists(PERSIST_KEY_SAVER_PCT)) {
+        s_saver_pct = persist_read_int(PERSIST_KEY_SAVER_PCT);
+    }
+    if (persist_exists(PERSIST_KEY_CRITICAL_PCT)) {
+        s_critical_pct = persist_read_int(PERSIST_KEY_CRITICAL_PCT);
+    }
+
+    s_level = level_for(battery_state_service_peek());
+    battery_state_service_subscribe(battery_handler);
+}
+
+void power_deinit(void) {
+    battery_state_service_unsubscribe();
+}
+
+const PowerPlan *power_plan(void) {
+    return &s_plans[s_level];
+}
+
+void power_set_thresholds(int saver_pct, int critical_pct) {
+    if (critical_pct > saver_pct) critical_pct = saver_pct;
+    if (saver_pct == s_saver_pct && critical_pct == s_critical_pct) return;
+
+    s_saver_pct    = saver_pct;
+    s_critical_pct = critical_pct;
+    persist_write_int(PERSIST_KEY_SAVER_PCT, saver_pct);
+    persist_write_int(PERSIST_KEY_CRITICAL_PCT, critical_pct);
+
+    apply(battery_state_service_peek());
+}
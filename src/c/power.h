@@ -0,0 +1,40 @@
+#pragma once
+
+#include <pebble.h>
+
+/* ---------------------------------------------------------------------------
+ * Battery-aware degradation policy
+ *
+ * Picks a power plan from the battery charge level: below the (phone-
+ * configurable) saver and critical thresholds the refresh interval grows
+ * and the chart drops its more expensive decorations.  While charging the
+ * normal plan always applies.
+ * --------------------------------------------------------------------------- */
+
+typedef enum {
+    POWER_NORMAL = 0,
+    POWER_SAVER,
+    POWER_CRITICAL
+} PowerLevel;
+
+typedef struct {
+    PowerLevel level;
+    uint8_t    refresh_minutes;  /* Fetch interval; must divide 60 */
+    bool       draw_grid;        /* Dotted value and time grid lines */
+    bool       draw_labels;      /* Extremum dots and labels */
+    bool       compact;          /* Thin line, no per-reading dots */
+} PowerPlan;
+
+/** Called whenever the active plan changes. */
+typedef void (*PowerPlanHandler)(const PowerPlan *plan);
+
+/** Load thresholds and subscribe to battery state changes. */
+void power_init(PowerPlanHandler handler);
+
+void power_deinit(void);
+
+/** The plan currently in effect. */
+const PowerPlan *power_plan(void);
+
+/** Update the saver / critical thresholds (percent); persisted. */
+void power_set_thresholds(int saver_pct, int critical_pct);
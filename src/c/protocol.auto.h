@@ -0,0 +1,372 @@
+/* Generated by tools/gen_protocol.py from protocol/schema.json - do not edit */
+#pragma once
+
+#include <pebble.h>
+#include "events.h"
+#include "history.h"
+
+#define PROTOCOL_VERSION  9
+
+/* Visible time window and one history page (3 hours) */
+#define VIEW_SECONDS  10800
+/* Densest sample interval sent; one reading per 1.5 px of chart height */
+#define MIN_SAMPLE_INTERVAL  150
+/* Readings per transfer: one page at MIN_SAMPLE_INTERVAL */
+#define MAX_READINGS  72
+/* Treatment events per transfer */
+#define MAX_EVENTS  32
+/* Yesterday's trace: the live window this far back */
+#define YESTERDAY_SHIFT  86400
+/* Yesterday's trace: one reading per this many seconds */
+#define YESTERDAY_INTERVAL  600
+/* Yesterday's trace: readings per transfer */
+#define YESTERDAY_MAX  20
+/* Statistics windows: 24 h, 7 d, 14 d, 30 d */
+#define STATS_WINDOWS  4
+/* Heatmap rows: local days, oldest first */
+#define HEATMAP_DAYS  7
+/* Heatmap cells: HEATMAP_DAYS rows of 24 hourly means */
+#define HEATMAP_CELLS  168
+/* Sparkline width: one pixel column per SPARK_COLUMN_SECONDS over 24 h */
+#define SPARK_COLUMNS  96
+/* Sparkline: time covered by one column */
+#define SPARK_COLUMN_SECONDS  900
+/* Sparkline height in pixel rows */
+#define SPARK_ROWS  14
+/* Sparkline: BG on the bottom row */
+#define SPARK_MIN_MGDL  40
+/* Sparkline: BG on the top row */
+#define SPARK_MAX_MGDL  400
+/* Sparkline: row value of a column with no readings */
+#define SPARK_EMPTY  255
+/* Phone-rendered chart: bitmap width in pixels */
+#define REMOTE_WIDTH  144
+/* Phone-rendered chart: bitmap height, the rows above the sparkline */
+#define REMOTE_HEIGHT  147
+/* Phone-rendered chart: most CHART_RLE bytes per message */
+#define REMOTE_CHUNK  1000
+/* Projected points: most per trace, VIEW_SECONDS / MIN_SAMPLE_INTERVAL plus a neighbour each side */
+#define POINTS_MAX  74
+/* Projected point flag: no segment joins it to the newer point before it */
+#define POINT_BREAK  1
+/* Projected point flag: a visible reading, marked with a dot */
+#define POINT_DOT  2
+/* BG_DATA: scheduled fetch of the live window */
+#define BG_DATA_SYNC  0
+/* BG_DATA: on-demand fetch of the newest reading, outside the schedule */
+#define BG_DATA_HEAD  1
+/* BG_STATUS: the phone's fetch failed; keep what is stored */
+#define BG_STATUS_FAILED  1
+/* BG_STATUS: the phone holds no readings at all */
+#define BG_STATUS_EMPTY  2
+
+/* Messages (keys in package.json "messageKeys")
+ *   Request (watch -> phone): PROTO_VERSION, BG_DATA, POWER_REFRESH_MIN [, BG_PAGE_END, CHART_LAYOUT]
+ *   Report (watch -> phone): PROTO_VERSION, ENERGY_REPORT
+ *   HeatmapRequest (watch -> phone): PROTO_VERSION, HEATMAP_REQUEST
+ *   Heatmap (phone -> watch): PROTO_VERSION, BG_UNITS, HEATMAP_START, BG_HEATMAP
+ *   Header (phone -> watch): PROTO_VERSION, BG_COUNT, BG_UNITS, BG_AXIS_AUTO, POWER_SAVER_PCT, POWER_CRITICAL_PCT [, BG_INTERVAL, BG_PAGE_END, BG_STATUS, BG_EVENTS, BG_YESTERDAY, BG_STATS, SPARK_END, BG_SPARK, CHART_SIZE, CHART_END, POINTS_END, POINTS_AXIS, BG_POINTS, BG_YESTERDAY_POINTS, BG_LABELS]
+ *   Head (phone -> watch): PROTO_VERSION, BG_HEAD
+ *   Chunk (phone -> watch): BG_CHUNK, BG_INDEX
+ *   ChartBitmap (phone -> watch): CHART_RLE, CHART_OFFSET
+ */
+
+/* ---------------------------------------------------------------------------
+ * Reading: 6 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_READING  6
+
+/** Decode one Reading at p. */
+static inline void proto_decode_reading(const uint8_t *p, GlucoseReading *out) {
+    out->value = (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+    out->timestamp = (time_t)((uint32_t)p[2] |
+                              ((uint32_t)p[3] << 8) |
+                              ((uint32_t)p[4] << 16) |
+                              ((uint32_t)p[5] << 24));
+}
+
+/** Decode up to max packed Readings from length bytes; returns the count. */
+static inline int proto_decode_readings(const uint8_t *data, int length,
+                                        GlucoseReading *out, int max) {
+    int n = length / BYTES_PER_READING;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_reading(data + i * BYTES_PER_READING, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * Event: 6 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_EVENT  6
+
+/** Decode one Event at p. */
+static inline void proto_decode_event(const uint8_t *p, TreatmentEvent *out) {
+    out->timestamp = (time_t)((uint32_t)p[0] |
+                              ((uint32_t)p[1] << 8) |
+                              ((uint32_t)p[2] << 16) |
+                              ((uint32_t)p[3] << 24));
+    out->kind = (uint8_t)(p[4]);
+    out->amount = (uint8_t)(p[5]);
+}
+
+/** Decode up to max packed Events from length bytes; returns the count. */
+static inline int proto_decode_events(const uint8_t *data, int length,
+                                      TreatmentEvent *out, int max) {
+    int n = length / BYTES_PER_EVENT;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_event(data + i * BYTES_PER_EVENT, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * StatsWindow: 12 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_STATS_WINDOW  12
+
+typedef struct {
+    uint16_t count;  /* Readings in the window */
+    uint16_t below;  /* Below range, 0.1 % */
+    uint16_t above;  /* Above range, 0.1 % */
+    int16_t mean;  /* Mean BG x10 in the header's units */
+    uint16_t cv;  /* Coefficient of variation, 0.1 % */
+    uint16_t gmi;  /* Glucose management indicator, 0.1 % */
+} StatsWindow;
+
+/** Decode one StatsWindow at p. */
+static inline void proto_decode_stats_window(const uint8_t *p, StatsWindow *out) {
+    out->count = (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+    out->below = (uint16_t)((uint16_t)p[2] | ((uint16_t)p[3] << 8));
+    out->above = (uint16_t)((uint16_t)p[4] | ((uint16_t)p[5] << 8));
+    out->mean = (int16_t)((uint16_t)p[6] | ((uint16_t)p[7] << 8));
+    out->cv = (uint16_t)((uint16_t)p[8] | ((uint16_t)p[9] << 8));
+    out->gmi = (uint16_t)((uint16_t)p[10] | ((uint16_t)p[11] << 8));
+}
+
+/** Decode up to max packed StatsWindows from length bytes; returns the count. */
+static inline int proto_decode_stats_windows(const uint8_t *data, int length,
+                                             StatsWindow *out, int max) {
+    int n = length / BYTES_PER_STATS_WINDOW;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_stats_window(data + i * BYTES_PER_STATS_WINDOW, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * HeatmapCell: 2 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_HEATMAP_CELL  2
+
+typedef struct {
+    int16_t mean;  /* Mean BG x10 in BG_UNITS; 0 = no readings */
+} HeatmapCell;
+
+/** Decode one HeatmapCell at p. */
+static inline void proto_decode_heatmap_cell(const uint8_t *p, HeatmapCell *out) {
+    out->mean = (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+/** Decode up to max packed HeatmapCells from length bytes; returns the count. */
+static inline int proto_decode_heatmap_cells(const uint8_t *data, int length,
+                                             HeatmapCell *out, int max) {
+    int n = length / BYTES_PER_HEATMAP_CELL;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_heatmap_cell(data + i * BYTES_PER_HEATMAP_CELL, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * SparkColumn: 2 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_SPARK_COLUMN  2
+
+typedef struct {
+    uint8_t lo;  /* Lowest row reached (0 = bottom); SPARK_EMPTY = no readings */
+    uint8_t hi;  /* Highest row reached */
+} SparkColumn;
+
+/** Decode one SparkColumn at p. */
+static inline void proto_decode_spark_column(const uint8_t *p, SparkColumn *out) {
+    out->lo = (uint8_t)(p[0]);
+    out->hi = (uint8_t)(p[1]);
+}
+
+/** Decode up to max packed SparkColumns from length bytes; returns the count. */
+static inline int proto_decode_spark_columns(const uint8_t *data, int length,
+                                             SparkColumn *out, int max) {
+    int n = length / BYTES_PER_SPARK_COLUMN;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_spark_column(data + i * BYTES_PER_SPARK_COLUMN, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * ChartPoint: 3 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_CHART_POINT  3
+
+typedef struct {
+    uint8_t x;  /* Screen column, clamped to the plot */
+    uint8_t y;  /* Screen row, clamped to the plot */
+    uint8_t flags;  /* POINT_BREAK, POINT_DOT */
+} ChartPoint;
+
+/** Decode one ChartPoint at p. */
+static inline void proto_decode_chart_point(const uint8_t *p, ChartPoint *out) {
+    out->x = (uint8_t)(p[0]);
+    out->y = (uint8_t)(p[1]);
+    out->flags = (uint8_t)(p[2]);
+}
+
+/** Decode up to max packed ChartPoints from length bytes; returns the count. */
+static inline int proto_decode_chart_points(const uint8_t *data, int length,
+                                            ChartPoint *out, int max) {
+    int n = length / BYTES_PER_CHART_POINT;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_chart_point(data + i * BYTES_PER_CHART_POINT, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * ChartLabel: 6 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_CHART_LABEL  6
+
+typedef struct {
+    uint8_t dot_x;  /* Extremum dot centre */
+    uint8_t dot_y;
+    uint8_t box_x;  /* Label box origin */
+    uint8_t box_y;
+    int16_t value;  /* BG x10 in the header's units */
+} ChartLabel;
+
+/** Decode one ChartLabel at p. */
+static inline void proto_decode_chart_label(const uint8_t *p, ChartLabel *out) {
+    out->dot_x = (uint8_t)(p[0]);
+    out->dot_y = (uint8_t)(p[1]);
+    out->box_x = (uint8_t)(p[2]);
+    out->box_y = (uint8_t)(p[3]);
+    out->value = (int16_t)((uint16_t)p[4] | ((uint16_t)p[5] << 8));
+}
+
+/** Decode up to max packed ChartLabels from length bytes; returns the count. */
+static inline int proto_decode_chart_labels(const uint8_t *data, int length,
+                                            ChartLabel *out, int max) {
+    int n = length / BYTES_PER_CHART_LABEL;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_chart_label(data + i * BYTES_PER_CHART_LABEL, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * ChartScale: 6 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_CHART_SCALE  6
+
+typedef struct {
+    int16_t min_bg;  /* Axis start, BG x10 in the header's units */
+    int16_t bg_range;
+    int16_t step;  /* Grid step; 0 = the fixed grid */
+} ChartScale;
+
+/** Decode one ChartScale at p. */
+static inline void proto_decode_chart_scale(const uint8_t *p, ChartScale *out) {
+    out->min_bg = (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+    out->bg_range = (int16_t)((uint16_t)p[2] | ((uint16_t)p[3] << 8));
+    out->step = (int16_t)((uint16_t)p[4] | ((uint16_t)p[5] << 8));
+}
+
+/** Decode up to max packed ChartScales from length bytes; returns the count. */
+static inline int proto_decode_chart_scales(const uint8_t *data, int length,
+                                            ChartScale *out, int max) {
+    int n = length / BYTES_PER_CHART_SCALE;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        proto_decode_chart_scale(data + i * BYTES_PER_CHART_SCALE, &out[i]);
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+ * ChartLayout: 9 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_CHART_LAYOUT  9
+
+typedef struct {
+    uint8_t chart_x;  /* Chart area; the plot is inset by padding */
+    uint8_t chart_y;
+    uint8_t chart_w;
+    uint8_t chart_h;
+    uint8_t padding;
+    uint16_t seconds_per_pixel;  /* Time scale, down the chart */
+    uint8_t label_w;  /* Extremum label box */
+    uint8_t label_h;
+} ChartLayout;
+
+/** Encode in into p (BYTES_PER_CHART_LAYOUT bytes). */
+static inline void proto_encode_chart_layout(const ChartLayout *in, uint8_t *p) {
+    p[0] = (uint8_t)(in->chart_x & 0xFF);
+    p[1] = (uint8_t)(in->chart_y & 0xFF);
+    p[2] = (uint8_t)(in->chart_w & 0xFF);
+    p[3] = (uint8_t)(in->chart_h & 0xFF);
+    p[4] = (uint8_t)(in->padding & 0xFF);
+    p[5] = (uint8_t)(in->seconds_per_pixel & 0xFF);
+    p[6] = (uint8_t)((in->seconds_per_pixel >> 8) & 0xFF);
+    p[7] = (uint8_t)(in->label_w & 0xFF);
+    p[8] = (uint8_t)(in->label_h & 0xFF);
+}
+
+/* ---------------------------------------------------------------------------
+ * EnergyReport: 28 bytes, little-endian
+ * --------------------------------------------------------------------------- */
+#define BYTES_PER_ENERGY_REPORT  28
+
+typedef struct {
+    uint32_t elapsed;  /* Seconds since counting started */
+    uint32_t counters[6];  /* Redraws, render ms, inbox messages, inbox bytes, outbox sends, wakeups */
+} EnergyReport;
+
+/** Encode in into p (BYTES_PER_ENERGY_REPORT bytes). */
+static inline void proto_encode_energy_report(const EnergyReport *in, uint8_t *p) {
+    p[0] = (uint8_t)(in->elapsed & 0xFF);
+    p[1] = (uint8_t)((in->elapsed >> 8) & 0xFF);
+    p[2] = (uint8_t)((in->elapsed >> 16) & 0xFF);
+    p[3] = (uint8_t)((in->elapsed >> 24) & 0xFF);
+    p[4] = (uint8_t)(in->counters[0] & 0xFF);
+    p[5] = (uint8_t)((in->counters[0] >> 8) & 0xFF);
+    p[6] = (uint8_t)((in->counters[0] >> 16) & 0xFF);
+    p[7] = (uint8_t)((in->counters[0] >> 24) & 0xFF);
+    p[8] = (uint8_t)(in->counters[1] & 0xFF);
+    p[9] = (uint8_t)((in->counters[1] >> 8) & 0xFF);
+    p[10] = (uint8_t)((in->counters[1] >> 16) & 0xFF);
+    p[11] = (uint8_t)((in->counters[1] >> 24) & 0xFF);
+    p[12] = (uint8_t)(in->counters[2] & 0xFF);
+    p[13] = (uint8_t)((in->counters[2] >> 8) & 0xFF);
+    p[14] = (uint8_t)((in->counters[2] >> 16) & 0xFF);
+    p[15] = (uint8_t)((in->counters[2] >> 24) & 0xFF);
+    p[16] = (uint8_t)(in->counters[3] & 0xFF);
+    p[17] = (uint8_t)((in->counters[3] >> 8) & 0xFF);
+    p[18] = (uint8_t)((in->counters[3] >> 16) & 0xFF);
+    p[19] = (uint8_t)((in->counters[3] >> 24) & 0xFF);
+    p[20] = (uint8_t)(in->counters[4] & 0xFF);
+    p[21] = (uint8_t)((in->counters[4] >> 8) & 0xFF);
+    p[22] = (uint8_t)((in->counters[4] >> 16) & 0xFF);
+    p[23] = (uint8_t)((in->counters[4] >> 24) & 0xFF);
+    p[24] = (uint8_t)(in->counters[5] & 0xFF);
+    p[25] = (uint8_t)((in->counters[5] >> 8) & 0xFF);
+    p[26] = (uint8_t)((in->counters[5] >> 16) & 0xFF);
+    p[27] = (uint8_t)((in->counters[5] >> 24) & 0xFF);
+}
@@ -0,0 +1,131 @@
+#include "remote.h"
+#include "log.h"
+
+#define REMOTE_PIXELS  (REMOTE_WIDTH * REMOTE_HEIGHT)
+
+static GBitmap *s_bitmap   = NULL;
+static size_t   s_size     = 0;      /* Encoded bytes announced */
+static size_t   s_received = 0;      /* ...and decoded so far */
+static int      s_pos      = 0;      /* Next pixel, row-major */
+static bool     s_changed  = false;  /* The next run is of changed pixels */
+static bool     s_pending  = false;
+static bool     s_complete = false;
+static time_t   s_view_end = 0;
+
+void remote_begin(size_t size, time_t view_end) {
+    if (!s_bitmap) {
+        s_bitmap = gbitmap_create_blank(GSize(REMOTE_WIDTH, REMOTE_HEIGHT),
+                                        GBitmapFormat1Bit);
+        if (!s_bitmap) {
+            LOG_WARNING("Phone-rendered chart: no heap");
+            remote_clear();
+            return;
+        }
+    }
+    memset(gbitmap_get_data(s_bitmap), 0,
+           gbitmap_get_bytes_per_row(s_bitmap) * REMOTE_HEIGHT);
+    s_size     = size;
+    s_received = 0;
+    s_pos      = 0;
+    s_changed  = false;
+    s_pending  = true;
+    s_complete = false;
+    s_view_end = view_end;
+}
+
+/** Set the bits of run changed pixels from s_pos, which it advances. */
+static void set_run(uint8_t *data, int stride, int run) {
+    while (run > 0) {
+        int y = s_pos / REMOTE_WIDTH;
+        int x = s_pos % REMOTE_WIDTH;
+        int n = REMOTE_WIDTH - x < run ? REMOTE_WIDTH - x : run;
+        uint8_t *row = data + y * stride;
+        for (int i = x; i < x + n; i++) {
+            row[i >> 3] |= 1 << (i & 7);  /* Leftmost pixel in bit 0 */
+        }
+        s_pos += n;
+        run   -= n;
+    }
+}
+
+/**
+ * Turn the decoded change bits into pixels: each row is XORed with the
+ * one above, and above the first lies a white row (set bits are white).
+ */
+static void unxor_rows(uint8_t *data, int stride) {
+    for (int b = 0; b < stride; b++) {
+        data[b] ^= 0xFF;
+    }
+    for (int y = 1; y < REMOTE_HEIGHT; y++) {
+        uint8_t *row = data + y * stride;
+        for (int b = 0; b < stride; b++) {
+            row[b] ^= row[b - stride];
+        }
+    }
+}
+
+bool remote_receive(size_t offset, const uint8_t *data, size_t length) {
+    if (!s_pending) return false;
+    if (offset != s_received || length > s_size - s_received) {
+        LOG_WARNING("Phone-rendered chart: bad chunk at %d",
+                    (int)offset);
+        remote_clear();
+        return false;
+    }
+
+    uint8_t *bits = gbitmap_get_data(s_bitmap);
+    int stride = gbitmap_get_bytes_per_row(s_bitmap);
+    for (size_t i = 0; i < length; i++) {
+        int run = data[i];
+        if (run > REMOTE_PIXELS - s_pos) {
+            remote_clear();
+            return false;
+        }
+        if (s_changed) {
+            set_run(bits, stride, run);
+        } else {
+            s_pos += run;
+        }
+        s_changed = !s_changed;
+    }
+    s_received += length;
+
+    if (s_received < s_size) return false;
+    if (s_pos != REMOTE_PIXELS) {
+        remote_clear();
+        return false;
+    }
+    unxor_rows(bits, stride);
+    s_pending  = false;
+    s_complete = true;
+    return true;
+}
+
+bool remote_pending(void) {
+    return s_pending;
+}
+
+time_t remote_view_end(void) {
+    return s_complete ? s_view_end : 0;
+}
+
+bool remote_draw(GContext *ctx) {
+    if (!s_complete) return false;
+    graphics_draw_bitmap_in_rect(ctx, s_bitmap,
+                                 GRect(0, 0, REMOTE_WIDTH, REMOTE_HEIGHT));
+    return true;
+}
+
+void remote_clear(void) {
+    s_pending  = false;
+    s_complete = false;
+    s_view_end = 0;
+}
+
+void remote_deinit(void) {
+    remote_clear();
+    if (s_bitmap) {
+        gbitmap_destroy(s_bitmap);
+        s_bitmap = NULL;
+    }
+}
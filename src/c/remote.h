@@ -0,0 +1,42 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * Phone-rendered chart
+ *
+ * In the phone-rendered mode (chosen per platform in the settings) the
+ * phone draws the live chart itself, as a REMOTE_WIDTH x REMOTE_HEIGHT
+ * 1-bit bitmap, and sends it after the readings.  Each pixel is XORed
+ * with the one above it, so the vertical grid lines and the flat parts of
+ * the frame vanish, and the result is sent as run lengths of alternating
+ * unchanged / changed pixels.  Runs are decoded into the bitmap as they
+ * arrive; the rows are un-XORed once the last chunk is in, and drawing is
+ * then a single blit.
+ * --------------------------------------------------------------------------- */
+
+/** Expect size encoded bytes of a bitmap drawn for view_end. */
+void remote_begin(size_t size, time_t view_end);
+
+/**
+ * Decode length bytes at offset into the encoding.  Returns true when
+ * this completed the bitmap; a chunk out of order or a malformed
+ * encoding drops it.
+ */
+bool remote_receive(size_t offset, const uint8_t *data, size_t length);
+
+/** True while a bitmap is announced but not complete. */
+bool remote_pending(void);
+
+/** The view end the complete bitmap was drawn for; 0 when there is none. */
+time_t remote_view_end(void);
+
+/** Blit the complete bitmap at the top-left of ctx; false if there is none. */
+bool remote_draw(GContext *ctx);
+
+/** Drop the bitmap (e.g. when a transfer without one replaces the data). */
+void remote_clear(void);
+
+/** Free the bitmap. */
+void remote_deinit(void);
@@ -0,0 +1,307 @@
+#include "request.h"
+#include "energy.h"
+#include "log.h"
+#include "power.h"
+#include "protocol.auto.h"
+
+/* Backoff for failed sends: 1 s, 2 s, 4 s ... capped at 60 s */
+#define RETRY_BASE_MS    1000
+#define RETRY_MAX_MS    60000
+
+/* Give up on a delivered page request whose reply never started */
+#define PAGE_REPLY_TIMEOUT_MS  30000
+
+/* Re-request a page the phone failed to fetch, with the same backoff,
+   this many times before leaving it to the next pan */
+#define PAGE_RETRY_LIMIT       5
+
+typedef enum {
+    REQUEST_NONE = 0,
+    REQUEST_SYNC,
+    REQUEST_HEAD,
+    REQUEST_PAGE,
+    REQUEST_REPORT,
+    REQUEST_HEATMAP
+} RequestKind;
+
+typedef enum {
+    PAGE_IDLE = 0,
+    PAGE_QUEUED,    /* waiting for the outbox */
+    PAGE_SENT,      /* delivered, waiting for the reply transfer */
+    PAGE_BACKOFF    /* the phone's fetch failed, waiting to re-request */
+} PageState;
+
+static bool        s_sync_queued    = false;
+static bool        s_head_queued    = false;
+static bool        s_report_queued  = false;
+static bool        s_heatmap_queued = false;
+static PageState   s_page_state     = PAGE_IDLE;
+static time_t      s_page_before    = 0;
+static RequestKind s_in_flight      = REQUEST_NONE;
+static int         s_retry_attempts = 0;
+static AppTimer   *s_retry_timer    = NULL;
+static AppTimer   *s_page_timer     = NULL;
+static int         s_page_failures  = 0;
+static bool        s_connected      = true;
+static bool        s_stale          = false;
+static RequestStaleHandler s_stale_handler = NULL;
+static uint8_t     s_layout[BYTES_PER_CHART_LAYOUT];
+static bool        s_has_layout     = false;
+
+static void set_stale(bool stale) {
+    if (s_stale == stale) return;
+    s_stale = stale;
+    if (s_stale_handler) {
+        s_stale_handler(stale);
+    }
+}
+
+static void pump(void);
+
+static void cancel_page_timer(void) {
+    if (s_page_timer) {
+        app_timer_cancel(s_page_timer);
+        s_page_timer = NULL;
+    }
+}
+
+static void page_timeout_callback(void *context) {
+    s_page_timer = NULL;
+    energy_add(ENERGY_WAKEUPS, 1);
+    LOG_WARNING("History page reply timed out");
+    s_page_state = PAGE_IDLE;
+}
+
+static void page_retry_callback(void *context) {
+    s_page_timer = NULL;
+    energy_add(ENERGY_WAKEUPS, 1);
+    s_page_state = PAGE_QUEUED;
+    pump();
+}
+
+/** Capped exponential backoff delay after the given number of attempts. */
+static uint32_t backoff_delay(int attempts) {
+    uint32_t delay = RETRY_BASE_MS;
+    for (int i = 0; i < attempts && delay < RETRY_MAX_MS; i++) {
+        delay *= 2;
+    }
+    return delay > RETRY_MAX_MS ? RETRY_MAX_MS : delay;
+}
+
+static void retry_timer_callback(void *context) {
+    s_retry_timer = NULL;
+    energy_add(ENERGY_WAKEUPS, 1);
+    pump();
+}
+
+/** Schedule the next send attempt with capped exponential backoff. */
+static void schedule_retry(void) {
+    if (s_retry_timer || !s_connected) return;
+
+    uint32_t delay = backoff_delay(s_retry_attempts);
+    s_retry_attempts++;
+
+    LOG_WARNING("Retrying request in %d ms", (int)delay);
+    s_retry_timer = app_timer_register(delay, retry_timer_callback, NULL);
+}
+
+/** Send the highest-priority queued request if the outbox is free. */
+static void pump(void) {
+    if (s_in_flight != REQUEST_NONE || s_retry_timer || !s_connected) return;
+
+    RequestKind kind = REQUEST_NONE;
+    if (s_sync_queued) {
+        kind = REQUEST_SYNC;
+    } else if (s_head_queued) {
+        kind = REQUEST_HEAD;
+    } else if (s_page_state == PAGE_QUEUED) {
+        kind = REQUEST_PAGE;
+    } else if (s_heatmap_queued) {
+        kind = REQUEST_HEATMAP;
+    } else if (s_report_queued) {
+        kind = REQUEST_REPORT;
+    }
+    if (kind == REQUEST_NONE) return;
+
+    DictionaryIterator *iter;
+    if (app_message_outbox_begin(&iter) != APP_MSG_OK || !iter) {
+        schedule_retry();
+        return;
+    }
+    dict_write_uint16(iter, MESSAGE_KEY_PROTO_VERSION, PROTOCOL_VERSION);
+    if (kind == REQUEST_REPORT) {
+        uint8_t report[BYTES_PER_ENERGY_REPORT];
+        energy_pack(report);
+        dict_write_data(iter, MESSAGE_KEY_ENERGY_REPORT, report, sizeof(report));
+    } else if (kind == REQUEST_HEATMAP) {
+        dict_write_uint8(iter, MESSAGE_KEY_HEATMAP_REQUEST, 1);
+    } else {
+        dict_write_uint8(iter, MESSAGE_KEY_BG_DATA,
+                         kind == REQUEST_HEAD ? BG_DATA_HEAD : BG_DATA_SYNC);
+        /* Let the phone follow the battery plan's refresh cadence */
+        dict_write_uint8(iter, MESSAGE_KEY_POWER_REFRESH_MIN,
+                         power_plan()->refresh_minutes);
+    }
+    if (kind == REQUEST_PAGE) {
+        dict_write_uint32(iter, MESSAGE_KEY_BG_PAGE_END, (uint32_t)s_page_before);
+    }
+    if (kind == REQUEST_SYNC && s_has_layout) {
+        dict_write_data(iter, MESSAGE_KEY_CHART_LAYOUT, s_layout, sizeof(s_layout));
+    }
+    if (app_message_outbox_send() != APP_MSG_OK) {
+        schedule_retry();
+        return;
+    }
+    s_in_flight = kind;
+    energy_add(ENERGY_OUTBOX_SENDS, 1);
+}
+
+static void outbox_sent_callback(DictionaryIterator *iterator, void *context) {
+    if (s_in_flight == REQUEST_SYNC) {
+        /* A sync brings the newest reading along with everything else */
+        s_sync_queued = false;
+        s_head_queued = false;
+    } else if (s_in_flight == REQUEST_HEAD) {
+        s_head_queued = false;
+    } else if (s_in_flight == REQUEST_REPORT) {
+        s_report_queued = false;
+    } else if (s_in_flight == REQUEST_HEATMAP) {
+        s_heatmap_queued = false;
+    } else if (s_in_flight == REQUEST_PAGE && s_page_state == PAGE_QUEUED) {
+        s_page_state = PAGE_SENT;
+        s_page_timer = app_timer_register(PAGE_REPLY_TIMEOUT_MS,
+                                          page_timeout_callback, NULL);
+    }
+    s_in_flight      = REQUEST_NONE;
+    s_retry_attempts = 0;
+    pump();
+}
+
+static void outbox_failed_callback(DictionaryIterator *iterator,
+                                    AppMessageResult reason,
+                                    void *context) {
+    LOG_ERROR("Message send failed: %d", reason);
+    /* The request stays queued; try again after the backoff delay */
+    s_in_flight = REQUEST_NONE;
+    schedule_retry();
+}
+
+static void app_connection_handler(bool connected) {
+    s_connected = connected;
+    if (!connected) {
+        /* Nothing can be delivered until the phone is back; a pending
+           page is re-requested by the next pan, live data by the sync
+           issued on reconnect. */
+        if (s_retry_timer) {
+            app_timer_cancel(s_retry_timer);
+            s_retry_timer = NULL;
+        }
+        cancel_page_timer();
+        s_retry_attempts = 0;
+        s_page_failures  = 0;
+        s_page_state     = PAGE_IDLE;
+        if (s_stale && s_stale_handler) {
+            /* Already stale after a failed fetch: now for want of a phone */
+            s_stale_handler(true);
+        }
+        set_stale(true);
+        return;
+    }
+    request_sync();
+}
+
+void request_init(RequestStaleHandler stale_handler) {
+    s_stale_handler = stale_handler;
+    s_connected = connection_service_peek_pebble_app_connection();
+    s_stale     = !s_connected;
+
+    app_message_register_outbox_sent(outbox_sent_callback);
+    app_message_register_outbox_failed(outbox_failed_callback);
+    connection_service_subscribe((ConnectionHandlers){
+        .pebble_app_connection_handler = app_connection_handler
+    });
+}
+
+void request_deinit(void) {
+    connection_service_unsubscribe();
+    cancel_page_timer();
+    if (s_retry_timer) {
+        app_timer_cancel(s_retry_timer);
+        s_retry_timer = NULL;
+    }
+}
+
+void request_sync(void) {
+    /* At most one sync is ever queued; re-requesting just nudges the pump */
+    s_sync_queued = true;
+    pump();
+}
+
+void request_head(void) {
+    if (s_sync_queued) return;
+    s_head_queued = true;
+    pump();
+}
+
+void request_page(time_t before_ts) {
+    if (s_page_state != PAGE_IDLE) return;
+    s_page_state  = PAGE_QUEUED;
+    s_page_before = before_ts;
+    pump();
+}
+
+void request_set_layout(const ChartLayout *layout) {
+    proto_encode_chart_layout(layout, s_layout);
+    s_has_layout = true;
+}
+
+void request_report(void) {
+    s_report_queued = true;
+    pump();
+}
+
+void request_heatmap(void) {
+    s_heatmap_queued = true;
+    pump();
+}
+
+bool request_page_pending(void) {
+    return s_page_state != PAGE_IDLE;
+}
+
+void request_page_done(void) {
+    cancel_page_timer();
+    s_page_failures = 0;
+    s_page_state    = PAGE_IDLE;
+}
+
+void request_page_failed(void) {
+    cancel_page_timer();
+    if (s_page_failures >= PAGE_RETRY_LIMIT) {
+        LOG_WARNING("History page fetch failed, giving up");
+        request_page_done();
+        return;
+    }
+    uint32_t delay = backoff_delay(s_page_failures);
+    s_page_failures++;
+
+    LOG_WARNING("History page fetch failed, retrying in %d ms", (int)delay);
+    s_page_state = PAGE_BACKOFF;
+    s_page_timer = app_timer_register(delay, page_retry_callback, NULL);
+}
+
+bool request_is_stale(void) {
+    return s_stale;
+}
+
+bool request_is_connected(void) {
+    return s_connected;
+}
+
+void request_mark_fresh(void) {
+    set_stale(false);
+}
+
+void request_mark_failed(void) {
+    set_stale(true);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * Watch -> phone request channel
+ *
+ * Owns the AppMessage outbox: every request to the phone goes through here.
+ * Requests are deduplicated (at most one sync, one newest-reading request and
+ * one history page queued),
+ * failed sends are retried with capped exponential backoff, and a single
+ * sync is issued as soon as the phone connection comes back.
+ * --------------------------------------------------------------------------- */
+
+/** Called whenever the stale flag changes (e.g. to trigger a redraw). */
+typedef void (*RequestStaleHandler)(bool stale);
+
+/** Register outbox callbacks and subscribe to connection events. */
+void request_init(RequestStaleHandler stale_handler);
+
+void request_deinit(void);
+
+/** Queue a fetch of the latest readings (no-op if one is already queued). */
+void request_sync(void);
+
+/**
+ * Queue an on-demand fetch of just the newest reading, outside the refresh
+ * schedule (no-op while a sync is queued, which brings it anyway).
+ */
+void request_head(void);
+
+/**
+ * Queue a fetch of the page of readings older than before_ts.  Ignored while
+ * a page request is queued or awaiting its reply.
+ */
+void request_page(time_t before_ts);
+
+/** Chart geometry to send with every sync, for projection on the phone. */
+void request_set_layout(const ChartLayout *layout);
+
+/** Queue a send of the energy counters to the phone log. */
+void request_report(void);
+
+/** Queue a request for the weekly heatmap (one reply message). */
+void request_heatmap(void);
+
+/** True while a page request is queued or awaiting its reply. */
+bool request_page_pending(void);
+
+/** Call when the page reply has arrived (or its transfer was abandoned). */
+void request_page_done(void);
+
+/**
+ * Call when the phone reports it could not fetch the page; it is requested
+ * again after a backoff delay and stays pending meanwhile.
+ */
+void request_page_failed(void);
+
+/**
+ * True from a phone disconnect or a failed fetch on the phone until the
+ * next successful sync.
+ */
+bool request_is_stale(void);
+
+/** True while the phone is connected. */
+bool request_is_connected(void);
+
+/** Call when a live transfer has completed; clears the stale flag. */
+void request_mark_fresh(void);
+
+/** Call when the phone reports a failed live fetch; sets the stale flag. */
+void request_mark_failed(void);
@@ -0,0 +1,97 @@
+#include "spark.h"
+#include "frame.h"
+
+#define LABEL_WIDTH    28  /* "24h", right-aligned like the time labels */
+
+/* Compile-time rows of the range thresholds, as the phone projects them */
+#define SPARK_SPAN       (SPARK_MAX_MGDL - SPARK_MIN_MGDL)
+#define SPARK_ROW(mgdl)  ((((mgdl) - SPARK_MIN_MGDL) * (SPARK_ROWS - 1) + \
+                           SPARK_SPAN / 2) / SPARK_SPAN)
+#define LOW_ROW          SPARK_ROW(70)
+#define HIGH_ROW         SPARK_ROW(180)
+
+static Layer      *s_layer = NULL;
+static SparkColumn s_columns[SPARK_COLUMNS];
+static int         s_count = 0;
+static time_t      s_end   = 0;
+static time_t      s_view_start = 0;  /* The chart's view */
+static time_t      s_view_end   = 0;
+
+/** Column holding time t, clamped to the strip. */
+static int column_at(time_t t) {
+    if (t >= s_end) return SPARK_COLUMNS - 1;
+    int column = SPARK_COLUMNS - 1 - (int)((s_end - t) / SPARK_COLUMN_SECONDS);
+    return column >= 0 ? column : 0;
+}
+
+static void spark_layer_update_proc(Layer *layer, GContext *ctx) {
+    if (s_count == 0) return;
+
+    GRect bounds = layer_get_bounds(layer);
+    int x0 = bounds.size.w - SPARK_COLUMNS - 2;
+    int bottom = SPARK_ROWS;  /* Row 0, under a pixel of bracket at the top */
+
+    graphics_context_set_text_color(ctx, GColorBlack);
+    graphics_draw_text(ctx, "24h", fonts_get_system_font(FONT_KEY_GOTHIC_14),
+                       GRect(0, -3, LABEL_WIDTH, 16),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentRight, NULL);
+
+    /* Bracket over the chart's window */
+    if (s_view_end > 0) {
+        int first = column_at(s_view_start);
+        int width = column_at(s_view_end) - first + 1;
+#ifdef PBL_COLOR
+        graphics_context_set_fill_color(ctx, GColorLightGray);
+        graphics_fill_rect(ctx, GRect(x0 + first, 0, width, SPARK_ROWS + 2),
+                           0, GCornerNone);
+#endif
+        graphics_context_set_stroke_color(ctx, GColorBlack);
+        graphics_draw_rect(ctx, GRect(x0 + first - 1, 0, width + 2,
+                                      SPARK_ROWS + 2));
+    }
+
+    /* Target range edges, every other pixel */
+    graphics_context_set_stroke_color(ctx, GColorBlack);
+    for (int x = 0; x < SPARK_COLUMNS; x += 2) {
+        graphics_draw_pixel(ctx, GPoint(x0 + x, bottom - LOW_ROW));
+        graphics_draw_pixel(ctx, GPoint(x0 + x, bottom - HIGH_ROW));
+    }
+
+    for (int i = 0; i < s_count; i++) {
+        const SparkColumn *c = &s_columns[i];
+        if (c->lo == SPARK_EMPTY) continue;
+        graphics_draw_line(ctx, GPoint(x0 + i, bottom - c->hi),
+                           GPoint(x0 + i, bottom - c->lo));
+    }
+}
+
+Layer *spark_create(GRect frame) {
+    s_layer = layer_create(frame);
+    layer_set_update_proc(s_layer, spark_layer_update_proc);
+    return s_layer;
+}
+
+void spark_destroy(void) {
+    layer_destroy(s_layer);
+    s_layer = NULL;
+}
+
+void spark_update(const SparkColumn *columns, int count, time_t end) {
+    if (count > SPARK_COLUMNS) count = SPARK_COLUMNS;
+    memcpy(s_columns, columns, count * sizeof(SparkColumn));
+    s_count = count;
+    s_end   = end;
+    frame_request(s_layer);
+}
+
+void spark_set_view(time_t view_start, time_t view_end) {
+    /* Redraw only when the bracket moves by a column */
+    bool moved = column_at(view_start) != column_at(s_view_start) ||
+                 column_at(view_end) != column_at(s_view_end);
+    s_view_start = view_start;
+    s_view_end   = view_end;
+    if (moved) {
+        frame_request(s_layer);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * 24-hour sparkline strip
+ *
+ * A SPARK_ROWS-high strip under the detail chart showing the last 24 hours
+ * with a bracket over the window the chart shows.  The phone sends each
+ * pixel column already projected, as the lowest and highest row reached,
+ * so drawing is one vertical line per column with no projection math.
+ * --------------------------------------------------------------------------- */
+
+/** Create the strip's layer at frame; the caller adds it to its window. */
+Layer *spark_create(GRect frame);
+
+void spark_destroy(void);
+
+/** Store the columns (oldest first) of a sparkline ending at end. */
+void spark_update(const SparkColumn *columns, int count, time_t end);
+
+/** Move the detail-window bracket to the view [view_start, view_end]. */
+void spark_set_view(time_t view_start, time_t view_end);
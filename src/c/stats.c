@@ -0,0 +1,135 @@
+#include "stats.h"
+#include "heatmap.h"
+
+#define TITLE_HEIGHT   24
+#define BLOCK_HEIGHT   32  /* Two 14 px text lines per window plus spacing */
+#define LINE_HEIGHT    15
+#define SIDE_INSET     PBL_IF_ROUND_ELSE(20, 4)
+
+static const char *const s_window_names[STATS_WINDOWS] = {
+    "24h", "7d", "14d", "30d"
+};
+
+static Window     *s_window  = NULL;
+static Layer      *s_layer   = NULL;
+static StatsWindow s_stats[STATS_WINDOWS];
+static int         s_count   = 0;
+static bool        s_is_mmol = false;
+
+/** Tenths of a percent to a rounded whole percent. */
+static int percent(int tenths) {
+    return (tenths + 5) / 10;
+}
+
+static void draw_line(GContext *ctx, const char *text, GFont font,
+                      GRect bounds, int y) {
+    graphics_draw_text(ctx, text, font,
+                       GRect(SIDE_INSET, y, bounds.size.w - 2 * SIDE_INSET,
+                             LINE_HEIGHT + 4),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentLeft, NULL);
+}
+
+static void stats_layer_update_proc(Layer *layer, GContext *ctx) {
+    GRect bounds = layer_get_bounds(layer);
+    GFont bold = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
+    GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+    char line[40];
+
+    graphics_context_set_text_color(ctx, GColorBlack);
+    graphics_draw_text(ctx, "Statistics",
+                       fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                       GRect(0, 0, bounds.size.w, TITLE_HEIGHT),
+                       GTextOverflowModeTrailingEllipsis,
+                       GTextAlignmentCenter, NULL);
+
+    if (s_count == 0) {
+        graphics_draw_text(ctx, "Waiting for phone", font,
+                           GRect(0, TITLE_HEIGHT, bounds.size.w, 20),
+                           GTextOverflowModeTrailingEllipsis,
+                           GTextAlignmentCenter, NULL);
+        return;
+    }
+
+    for (int i = 0; i < s_count; i++) {
+        const StatsWindow *w = &s_stats[i];
+        int y = TITLE_HEIGHT + i * BLOCK_HEIGHT;
+
+        if (w->count == 0) {
+            snprintf(line, sizeof(line), "%s  no data", s_window_names[i]);
+            draw_line(ctx, line, bold, bounds, y);
+            continue;
+        }
+
+        int in_range = 1000 - w->below - w->above;
+        snprintf(line, sizeof(line), "%s  In %d%%  <%d%%  >%d%%",
+                 s_window_names[i], percent(in_range),
+                 percent(w->below), percent(w->above));
+        draw_line(ctx, line, bold, bounds, y);
+
+        if (s_is_mmol) {
+            snprintf(line, sizeof(line), "avg %d.%d  CV %d%%  GMI %d.%d%%",
+                     w->mean / 10, w->mean % 10, percent(w->cv),
+                     w->gmi / 10, w->gmi % 10);
+        } else {
+            snprintf(line, sizeof(line), "avg %d  CV %d%%  GMI %d.%d%%",
+                     (w->mean + 5) / 10, percent(w->cv),
+                     w->gmi / 10, w->gmi % 10);
+        }
+        draw_line(ctx, line, font, bounds, y + LINE_HEIGHT);
+    }
+}
+
+/** Select opens the weekly heatmap. */
+static void select_click_handler(ClickRecognizerRef recognizer, void *context) {
+    heatmap_window_push();
+}
+
+static void click_config_provider(void *context) {
+    window_single_click_subscribe(BUTTON_ID_SELECT, select_click_handler);
+}
+
+static void stats_window_load(Window *window) {
+    Layer *window_layer = window_get_root_layer(window);
+    GRect bounds = layer_get_bounds(window_layer);
+    /* Round screens: keep the blocks clear of the curved top */
+    bounds.origin.y = PBL_IF_ROUND_ELSE(12, 0);
+    s_layer = layer_create(bounds);
+    layer_set_update_proc(s_layer, stats_layer_update_proc);
+    layer_add_child(window_layer, s_layer);
+}
+
+static void stats_window_unload(Window *window) {
+    layer_destroy(s_layer);
+    s_layer = NULL;
+}
+
+void stats_update(const StatsWindow *windows, int count, bool is_mmol) {
+    if (count > STATS_WINDOWS) count = STATS_WINDOWS;
+    memcpy(s_stats, windows, count * sizeof(StatsWindow));
+    s_count   = count;
+    s_is_mmol = is_mmol;
+    if (s_layer) {
+        layer_mark_dirty(s_layer);
+    }
+}
+
+void stats_window_push(void) {
+    if (!s_window) {
+        s_window = window_create();
+        window_set_background_color(s_window, GColorWhite);
+        window_set_window_handlers(s_window, (WindowHandlers){
+            .load   = stats_window_load,
+            .unload = stats_window_unload
+        });
+        window_set_click_config_provider(s_window, click_config_provider);
+    }
+    window_stack_push(s_window, true);
+}
+
+void stats_deinit(void) {
+    if (s_window) {
+        window_destroy(s_window);
+        s_window = NULL;
+    }
+}
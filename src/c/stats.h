@@ -0,0 +1,24 @@
+#pragma once
+
+#include <pebble.h>
+#include "protocol.auto.h"
+
+/* ---------------------------------------------------------------------------
+ * Statistics page
+ *
+ * Time in range, mean, CV and GMI over 24 h, 7 d, 14 d and 30 d.  The phone
+ * keeps the aggregates and sends a fixed-size summary only when a value
+ * changes; this module holds the latest one and shows it in its own window.
+ * --------------------------------------------------------------------------- */
+
+/**
+ * Store a summary (STATS_WINDOWS entries in window order; means x10 in the
+ * given units) and redraw the page if it is open.
+ */
+void stats_update(const StatsWindow *windows, int count, bool is_mmol);
+
+/** Push the statistics window onto the window stack. */
+void stats_window_push(void);
+
+/** Destroy the statistics window. */
+void stats_deinit(void);
@@ -0,0 +1,76 @@
+// Glucose axis scale, picked as the watch's src/c/axis.c picks it
+// ES5 compatible version
+//
+// Used where the phone draws or projects for the watch, so both ends
+// agree on the scale: the fixed 0-360 mg/dL / 0-20 mmol/L axis or an auto
+// range snapped to a "nice" step, which widens at once but narrows only
+// once the data fits a clearly smaller range.
+
+var AUTO_MAX_INTERVALS = 5;
+var MGDL_MIN_SPAN = 60;
+var MMOL_MIN_SPAN = 30;
+var MGDL_STEPS = [20, 25, 50, 100];
+var MMOL_STEPS = [10, 20, 25, 50];
+/* Narrow the auto range only when the new one is at most 2/3 as wide */
+var SHRINK_NUM = 2;
+var SHRINK_DEN = 3;
+
+/* The scale in effect, kept between calls for the hysteresis */
+var current = null;
+
+/** Integer division as C does it: toward zero */
+function trunc(x) {
+    return x < 0 ? Math.ceil(x) : Math.floor(x);
+}
+
+/** Smallest nice range covering [lo, hi] */
+function fit(lo, hi, isMmol) {
+    var minSpan = isMmol ? MMOL_MIN_SPAN : MGDL_MIN_SPAN;
+    if (hi - lo < minSpan) {
+        var mid = trunc((lo + hi) / 2);
+        lo = mid - trunc(minSpan / 2);
+        hi = lo + minSpan;
+    }
+    if (lo < 0) {
+        hi -= lo;
+        lo = 0;
+    }
+    var steps = isMmol ? MMOL_STEPS : MGDL_STEPS;
+    var scale = null;
+    for (var i = 0; i < steps.length; i++) {
+        var step = steps[i];
+        var mn = Math.floor(lo / step) * step;
+        var mx = Math.ceil(hi / step) * step;
+        scale = { minBg: mn, range: mx - mn, step: step };
+        if (scale.range / step <= AUTO_MAX_INTERVALS) break;
+    }
+    return scale;
+}
+
+/**
+ * Pick the scale for the units, mode and visible extrema [lo, hi] (lo > hi
+ * when nothing is visible, which keeps the current range), as
+ * axis_update() does
+ * @returns {Object} {minBg, range, step}; step 0 = the fixed grid
+ */
+function update(isMmol, autoRange, lo, hi) {
+    var modeChanged = !current || current.isMmol !== isMmol || current.auto !== autoRange;
+    if (!autoRange || lo > hi) {
+        if (modeChanged) {
+            current = { minBg: 0, range: isMmol ? 200 : 360, step: 0 };
+        }
+    } else {
+        var scale = fit(lo, hi, isMmol);
+        var keep = !modeChanged && ((lo >= current.minBg && hi <= current.minBg + current.range &&
+            scale.range * SHRINK_DEN > current.range * SHRINK_NUM) ||
+            (scale.minBg === current.minBg && scale.range === current.range));
+        if (!keep) {
+            current = scale;
+        }
+    }
+    current.isMmol = isMmol;
+    current.auto = autoRange;
+    return { minBg: current.minBg, range: current.range, step: current.step };
+}
+
+module.exports = { update: update, trunc: trunc };
@@ -1,6 +1,8 @@
 //Credits: https://github.com/gagebenne/pydexcom
 // ES5 compatible version
 
+var Log = require('./log');
+
 // Constants
 var DEXCOM_APPLICATION_ID_US = 'd89443d2-327c-4a6f-89e5-496bbb0317db';
 var DEXCOM_APPLICATION_ID_OUS = DEXCOM_APPLICATION_ID_US;
@@ -32,26 +34,50 @@ var AppIDs = {
     jp: DEXCOM_APPLICATION_ID_JP
 };
 
+// Probed concurrently when the region is not known
+var PROBE_REGIONS = [Regions.US, Regions.OUS, Regions.JP];
+var NULL_ACCOUNT_ID = '00000000-0000-0000-0000-000000000000';
+
+// HTTP traffic counters shared by all clients (energy report)
+var httpStats = {
+    since: Date.now(),
+    requests: 0,
+    bytesSent: 0,
+    bytesReceived: 0
+};
+
 /**
  * Dexcom constructor
  * @param {string} username - Dexcom username
  * @param {string} password - Dexcom password
  * @param {Function} onResults - Callback on successful glucose fetch
- * @param {string} region - Region code (us, ous, jp)
+ * @param {string} region - Region code (us, ous, jp); null to find it
+ *   on first authentication
  * @param {Function} onError - Callback on fetch error (optional)
  */
 function Dexcom(username, password, onResults, region, onError) {
     this.username = username;
     this.password = password;
-    this.region = (region || Regions.OUS).toLowerCase();
-    this.baseUrl = BaseURLs[this.region] || BaseURLs.ous;
-    this.applicationId = AppIDs[this.region] || AppIDs.ous;
+    this.region = null;
+    this.baseUrl = null;
+    this.applicationId = null;
+    if (region) this.setRegion(region);
     this.sessionId = null;
     this.accountId = null;
     this.onResults = onResults;
     this.onError = onError || null;
 }
 
+/**
+ * Point the client at a region's server
+ * @param {string} region - Region code (us, ous, jp)
+ */
+Dexcom.prototype.setRegion = function(region) {
+    this.region = BaseURLs[region.toLowerCase()] ? region.toLowerCase() : Regions.OUS;
+    this.baseUrl = BaseURLs[this.region];
+    this.applicationId = AppIDs[this.region];
+};
+
 /**
  * Make XHR request
  * @param {string} method - HTTP method
@@ -67,6 +93,23 @@ Dexcom.prototype.xhr = function(method, url) {
     return req;
 };
 
+/**
+ * Send an XHR request, counting it and its payload sizes in httpStats.
+ * Must be called after the onload handler is assigned.
+ * @param {XMLHttpRequest} req - Opened request
+ * @param {string} body - Request body
+ */
+Dexcom.prototype.send = function(req, body) {
+    var onload = req.onload;
+    req.onload = function() {
+        httpStats.bytesReceived += (req.responseText || '').length;
+        if (onload) onload.apply(this, arguments);
+    };
+    httpStats.requests++;
+    httpStats.bytesSent += body.length;
+    req.send(body);
+};
+
 /**
  * Trim quotes from string
  * @param {string} str - String to trim
@@ -174,8 +217,9 @@ Dexcom.prototype.authenticate = function(callback) {
     try {
         // Step 1: Get account ID if not already set
         if (!this.accountId) {
-            console.log('Getting account ID...');
-            this._getAccountId(function() {
+            if (Log.debug) Log.debug('Getting account ID...');
+            var getAccountId = this.region ? this._getAccountId : this._probeRegions;
+            getAccountId.call(this, function() {
                 // Step 2: Get session ID
                 self._getSessionId(callback);
             });
@@ -187,7 +231,7 @@ Dexcom.prototype.authenticate = function(callback) {
             callback.call(self);
         }
     } catch (error) {
-        console.error('Authentication error: ' + error.message);
+        Log.error('Authentication error: ' + error.message);
         if (this.onError) this.onError('Authentication error: ' + error.message);
     }
 };
@@ -206,38 +250,96 @@ Dexcom.prototype._getAccountId = function(callback) {
 
         if (req.status === 200) {
             self.accountId = self.trimQuotes(req.responseText);
-            console.log('Account ID: ' + self.accountId);
+            if (Log.debug) Log.debug('Account ID: ' + self.accountId);
 
-            if (self.accountId === '00000000-0000-0000-0000-000000000000') {
-                console.error('Invalid credentials');
+            if (self.accountId === NULL_ACCOUNT_ID) {
+                Log.error('Invalid credentials');
                 if (self.onError) self.onError('Invalid credentials');
                 return;
             }
 
             callback.call(self);
         } else {
-            console.error('Error fetching account ID: ' + req.status);
+            Log.error('Error fetching account ID: ' + req.status);
             if (self.onError) self.onError('Error fetching account ID: ' + req.status);
         }
     };
 
     req.onerror = function() {
-        console.error('Network error fetching account ID');
+        Log.error('Network error fetching account ID');
         if (self.onError) self.onError('Network error fetching account ID');
     };
 
     req.ontimeout = function() {
-        console.error('Timeout fetching account ID');
+        Log.error('Timeout fetching account ID');
         if (self.onError) self.onError('Timeout fetching account ID');
     };
 
-    req.send(JSON.stringify({
+    this.send(req, JSON.stringify({
         accountName: this.username,
         password: this.password,
         applicationId: this.applicationId
     }));
 };
 
+/**
+ * Find the account's region: ask every region's server for the account
+ * ID at once and keep the first valid answer, aborting the rest
+ * @param {Function} callback - Callback when complete
+ */
+Dexcom.prototype._probeRegions = function(callback) {
+    var self = this;
+    var pending = PROBE_REGIONS.length;
+    var requests = [];
+    var rejected = false;
+    var settled = false;
+
+    function fail(region, reason) {
+        if (Log.debug) Log.debug('Region ' + region + ': ' + reason);
+        if (settled || --pending > 0) return;
+        settled = true;
+        var message = rejected ? 'Invalid credentials' : 'Error fetching account ID in any region';
+        Log.error(message);
+        if (self.onError) self.onError(message);
+    }
+
+    PROBE_REGIONS.forEach(function(region) {
+        var req = self.xhr('POST', BaseURLs[region] + DEXCOM_AUTHENTICATE_ENDPOINT);
+        req.timeout = 15000;
+        requests.push(req);
+
+        req.onload = function() {
+            if (settled || req.readyState !== 4) return;
+            if (req.status !== 200) {
+                fail(region, 'HTTP ' + req.status);
+                return;
+            }
+            var accountId = self.trimQuotes(req.responseText);
+            if (accountId === NULL_ACCOUNT_ID) {
+                rejected = true;
+                fail(region, 'no such account');
+                return;
+            }
+            settled = true;
+            requests.forEach(function(other) {
+                if (other !== req && other.readyState !== 4) other.abort();
+            });
+            self.setRegion(region);
+            self.accountId = accountId;
+            if (Log.info) Log.info('Account ID: ' + accountId + ' (region ' + region + ')');
+            callback.call(self);
+        };
+        req.onerror = function() { fail(region, 'network error'); };
+        req.ontimeout = function() { fail(region, 'timeout'); };
+
+        self.send(req, JSON.stringify({
+            accountName: self.username,
+            password: self.password,
+            applicationId: AppIDs[region]
+        }));
+    });
+};
+
 /**
  * Get session ID from Dexcom API
  * @param {Function} callback - Callback when complete
@@ -257,42 +359,42 @@ Dexcom.prototype._getSessionId = function(callback) {
 
         if (loginReq.status === 200) {
             self.sessionId = self.trimQuotes(loginReq.responseText);
-            console.log('Session ID: ' + self.sessionId);
+            if (Log.debug) Log.debug('Session ID: ' + self.sessionId);
 
             if (self.sessionId === '00000000-0000-0000-0000-000000000000') {
-                console.error('Login failed');
+                Log.error('Login failed');
                 if (self.onError) self.onError('Login failed');
                 return;
             }
 
             callback.call(self);
         } else {
-            console.error('Error fetching session ID: ' + loginReq.status);
+            Log.error('Error fetching session ID: ' + loginReq.status);
             if (self.onError) self.onError('Error fetching session ID: ' + loginReq.status);
         }
     };
 
     loginReq.onerror = function() {
         if (timeoutHandle) clearTimeout(timeoutHandle);
-        console.error('Network error fetching session ID');
+        Log.error('Network error fetching session ID');
         if (self.onError) self.onError('Network error fetching session ID');
     };
 
     loginReq.ontimeout = function() {
         if (timeoutHandle) clearTimeout(timeoutHandle);
-        console.error('Timeout fetching session ID (15s)');
+        Log.error('Timeout fetching session ID (15s)');
         if (self.onError) self.onError('Timeout fetching session ID');
     };
 
     // Fallback timeout using setTimeout for better compatibility
     timeoutHandle = setTimeout(function() {
         if (loginReq.readyState !== 4) {
-            console.error('Request timeout: session ID fetch took too long');
+            Log.error('Request timeout: session ID fetch took too long');
             loginReq.abort();
         }
     }, 15000);
 
-    loginReq.send(JSON.stringify({
+    this.send(loginReq, JSON.stringify({
         accountId: this.accountId,
         password: this.password,
         applicationId: this.applicationId
@@ -329,7 +431,7 @@ Dexcom.prototype._fetchGlucoseReadings = function(minutes, maxCount) {
     var self = this;
     
     try {
-        console.log('Fetching glucose readings for ' + minutes + ' minutes...');
+        if (Log.debug) Log.debug('Fetching glucose readings for ' + minutes + ' minutes...');
 
         var url = this.baseUrl + DEXCOM_GLUCOSE_READINGS_ENDPOINT;
         var req = this.xhr('POST', url);
@@ -348,41 +450,41 @@ Dexcom.prototype._fetchGlucoseReadings = function(minutes, maxCount) {
                 } else if (req.status === 500) {
                     self._handleServerError(JSON.parse(req.responseText), minutes, maxCount);
                 } else {
-                    console.error('Failed to get readings: HTTP ' + req.status);
+                    Log.error('Failed to get readings: HTTP ' + req.status);
                     if (self.onError) self.onError('Unable to retrieve glucose readings from Dexcom server');
                 }
             } catch (error) {
-                console.error('Error processing response: ' + error.message);
+                Log.error('Error processing response: ' + error.message);
             }
         };
 
         req.onerror = function() {
             if (timeoutHandle) clearTimeout(timeoutHandle);
-            console.error('Network error fetching glucose readings');
+            Log.error('Network error fetching glucose readings');
             if (self.onError) self.onError('Network error fetching glucose readings');
         };
 
         req.ontimeout = function() {
             if (timeoutHandle) clearTimeout(timeoutHandle);
-            console.error('Timeout fetching glucose readings (15s)');
+            Log.error('Timeout fetching glucose readings (15s)');
             if (self.onError) self.onError('Timeout fetching glucose readings');
         };
 
         // Fallback timeout using setTimeout for better compatibility
         timeoutHandle = setTimeout(function() {
             if (req.readyState !== 4) {
-                console.error('Request timeout: glucose readings fetch took too long');
+                Log.error('Request timeout: glucose readings fetch took too long');
                 req.abort();
             }
         }, 15000);
 
-        req.send(JSON.stringify({
+        this.send(req, JSON.stringify({
             sessionId: this.sessionId,
             minutes: minutes,
             maxCount: maxCount
         }));
     } catch (error) {
-        console.error('Error fetching glucose: ' + error.message);
+        Log.error('Error fetching glucose: ' + error.message);
         if (self.onError) self.onError('Error fetching glucose: ' + error.message);
     }
 };
@@ -393,7 +495,7 @@ Dexcom.prototype._fetchGlucoseReadings = function(minutes, maxCount) {
  */
 Dexcom.prototype._handleGlucoseResponse = function(readings) {
     if (!Array.isArray(readings) || readings.length === 0) {
-        console.log('No readings available');
+        if (Log.debug) Log.debug('No readings available');
         this.onResults([]);
         return;
     }
@@ -424,21 +526,23 @@ Dexcom.prototype._handleServerError = function(error, minutes, maxCount) {
         // Limit retries to prevent infinite loop
         if (this.retryCount < 2) {
             this.retryCount++;
-            console.log('Session error: ' + error.Code + ', re-authenticating (attempt ' + this.retryCount + ')...');
+            if (Log.warn) Log.warn('Session error: ' + error.Code + ', re-authenticating (attempt ' + this.retryCount + ')...');
             this.sessionId = null;
             this.authenticate(function() {
                 self.getGlucoseReadings(minutes, maxCount);
             });
         } else {
-            console.error('Session error: ' + error.Code + ', max retries reached (' + this.retryCount + ')');
+            Log.error('Session error: ' + error.Code + ', max retries reached (' + this.retryCount + ')');
             this.retryCount = 0;
             if (this.onError) this.onError('Session error: ' + error.Code + ', max retries reached');
         }
     } else {
         this.retryCount = 0;
-        console.error('Server error: ' + error.Message);
+        Log.error('Server error: ' + error.Message);
         if (this.onError) this.onError('Server error: ' + error.Message);
     }
 };
 
+Dexcom.stats = httpStats;
+
 module.exports = Dexcom;
@@ -0,0 +1,9 @@
+/*
+ * PebbleKit JS entry point for LOG_LEVEL=debug builds
+ * (LOG_LEVEL=debug pebble build): src/pkjs/index.js with the phone's
+ * loggers raised to debug.
+ */
+'use strict';
+
+require('../log').setLevel('debug');
+require('../index');
@@ -0,0 +1,9 @@
+/*
+ * PebbleKit JS entry point for LOG_LEVEL=info builds
+ * (LOG_LEVEL=info pebble build): src/pkjs/index.js with the phone's
+ * loggers raised to info.
+ */
+'use strict';
+
+require('../log').setLevel('info');
+require('../index');
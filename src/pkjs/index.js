@@ -1,16 +1,65 @@
 var Dexcom = require('./dexcom');
-var Clay = require('pebble-clay');
-var clayConfig = require('./config.json');
-var clay = new Clay(clayConfig);
+var Log = require('./log');
+var Nightscout = require('./nightscout');
+var Project = require('./project');
+var Render = require('./render');
+var Sparkline = require('./sparkline');
+var Stats = require('./stats');
+/* Wire constants and codecs generated from protocol/schema.json */
+var Protocol = require('./protocol.auto');
+
+/* Clay is only needed when the settings page is opened; it is loaded on
+   first use so it does not delay the first fetch at startup. */
+var clay = null;
 
 var appSettings = {};
 var MMOL_CONVERSION_FACTOR = 18.0182;
 /* Sized larger than MAX_READINGS so all readings always fit in one chunk */
 var MAX_READINGS_PER_CHUNK = 316;
-var MAX_READINGS = 36;
 var CACHE_KEY = 'glucose_cache';
-var CACHE_DURATION = 10800; /* 3 hours in seconds */
+var EVENTS_KEY = 'event_cache';
+var EVENTS_FETCHED_KEY = 'event_fetched';
+var STATS_KEY = 'glucose_stats';
+var LAYOUT_KEY = 'chart_layout';
+var GENERATION_KEY = 'cache_generation';
+var PAYLOAD_KEY = 'encoded_payloads';
+var PAYLOAD_SLOTS = 4; /* Encoded payloads kept: the live one and recent history pages */
+var CACHE_DURATION = 86400; /* 24 hours in seconds: live window plus history pages */
+var PAGE_DURATION = Protocol.VIEW_SECONDS; /* 3 hours in seconds: one watch page */
+/* Readings are retained long enough to cover yesterday's trace */
+var RETAIN_DURATION = Protocol.YESTERDAY_SHIFT + PAGE_DURATION;
+var MAX_HISTORY_COUNT = 288; /* Dexcom Share maxCount limit */
+var DEFAULT_SAMPLE_INTERVAL = 300; /* 5-minute CGM data */
+/* Watch pixel budget: denser sources are decimated to this */
+var MIN_SAMPLE_INTERVAL = Protocol.MIN_SAMPLE_INTERVAL;
+var DEFAULT_REFRESH_MINUTES = 5;
+var DEFAULT_POWER_SAVER_PCT = 30;
+var DEFAULT_POWER_CRITICAL_PCT = 10;
+/* Order of the PHONE_RENDER checkboxes in config.json */
+var RENDER_PLATFORMS = ['aplite', 'basalt', 'chalk', 'diorite', 'emery'];
 var isFetchInProgress = false;
+var pendingFetch = false;
+var pendingPageEnd = null;
+/* Refresh interval of the watch's battery plan, from its latest request */
+var watchRefreshMinutes = DEFAULT_REFRESH_MINUTES;
+var lastFetchTime = 0;
+/* Encoded stats summary last sent to the watch this session */
+var lastStatsSent = null;
+/* Recently encoded payloads, newest first (see payloadKey()); null until
+   loaded from PAYLOAD_KEY */
+var payloadMemo = null;
+
+/**
+ * Load Clay and its config on first use
+ */
+function getClay() {
+    if (!clay) {
+        var Clay = require('pebble-clay');
+        var clayConfig = require('./config.json');
+        clay = new Clay(clayConfig, null, { autoHandleEvents: false });
+    }
+    return clay;
+}
 
 /**
  * Load settings from local storage
@@ -19,7 +68,7 @@ function getSettings() {
     try {
         return JSON.parse(window.localStorage.getItem('clay-settings')) || {};
     } catch (e) {
-        console.error('Error parsing settings: ' + e.message);
+        Log.error('Error parsing settings: ' + e.message);
         return {};
     }
 }
@@ -35,36 +84,105 @@ function convertBGValue(value, units) {
 }
 
 /**
- * Load glucose cache from localStorage
+ * Load a cached array from localStorage
  */
-function loadCache() {
+function loadArray(key) {
     try {
-        var raw = window.localStorage.getItem(CACHE_KEY);
+        var raw = window.localStorage.getItem(key);
         if (!raw) return [];
         var parsed = JSON.parse(raw);
         if (!Array.isArray(parsed)) return [];
         return parsed;
     } catch (e) {
-        console.error('Error loading cache: ' + e.message);
+        Log.error('Error loading ' + key + ': ' + e.message);
         return [];
     }
 }
 
+/**
+ * Save a cached array to localStorage. A change to it bumps the data
+ * generation, which invalidates the encoded payloads.
+ */
+function saveArray(key, list) {
+    try {
+        var json = JSON.stringify(list);
+        if (window.localStorage.getItem(key) === json) return;
+        window.localStorage.setItem(key, json);
+        window.localStorage.setItem(GENERATION_KEY, String(loadGeneration() + 1));
+    } catch (e) {
+        Log.error('Error saving ' + key + ': ' + e.message);
+    }
+}
+
+/**
+ * Generation of the cached readings and events: bumped on every change
+ */
+function loadGeneration() {
+    return parseInt(window.localStorage.getItem(GENERATION_KEY), 10) || 0;
+}
+
+/**
+ * Load glucose cache from localStorage
+ */
+function loadCache() {
+    return loadArray(CACHE_KEY);
+}
+
 /**
  * Save glucose cache to localStorage
  */
 function saveCache(cache) {
+    saveArray(CACHE_KEY, cache);
+}
+
+/**
+ * Load the rolling statistics; an install without them is seeded from the
+ * cached readings
+ */
+function loadStats() {
+    var state = null;
     try {
-        window.localStorage.setItem(CACHE_KEY, JSON.stringify(cache));
+        state = JSON.parse(window.localStorage.getItem(STATS_KEY));
     } catch (e) {
-        console.error('Error saving cache: ' + e.message);
+        Log.error('Error loading ' + STATS_KEY + ': ' + e.message);
     }
+    if (state) return new Stats(state);
+
+    var stats = new Stats();
+    var cache = loadCache();
+    for (var i = 0; i < cache.length; i++) {
+        stats.add(cache[i]);
+    }
+    stats.advance(Math.floor(Date.now() / 1000));
+    return stats;
+}
+
+/**
+ * Save the rolling statistics to localStorage
+ */
+function saveStats(stats) {
+    try {
+        window.localStorage.setItem(STATS_KEY, JSON.stringify(stats));
+    } catch (e) {
+        Log.error('Error saving ' + STATS_KEY + ': ' + e.message);
+    }
+}
+
+/**
+ * Load the treatment event index {t, k, a} (sorted descending)
+ */
+function loadEvents() {
+    return loadArray(EVENTS_KEY);
 }
 
 /**
- * Merge new readings into cache, deduplicate by timestamp, sort descending, truncate
+ * Merge new readings into cache, deduplicate by timestamp, sort descending,
+ * truncate to RETAIN_DURATION (yesterday's trace reaches past the 24 h
+ * CACHE_DURATION). Readings new to the cache are added to stats, if
+ * given; anything older than the cache is never re-added since the
+ * cutoff only moves forward.
  */
-function mergeCache(cache, newReadings) {
+function mergeCache(cache, newReadings, stats) {
     var byTimestamp = {};
     var i;
 
@@ -74,10 +192,18 @@ function mergeCache(cache, newReadings) {
     }
 
     /* Add/overwrite with new readings */
+    var now = Math.floor(Date.now() / 1000);
+    var cutoff = now - RETAIN_DURATION;
     for (i = 0; i < newReadings.length; i++) {
         var r = newReadings[i];
+        if (stats && r.t >= cutoff && !byTimestamp.hasOwnProperty(r.t)) {
+            stats.add(r);
+        }
         byTimestamp[r.t] = r;
     }
+    if (stats) {
+        stats.advance(now);
+    }
 
     /* Collect into array */
     var merged = [];
@@ -90,8 +216,7 @@ function mergeCache(cache, newReadings) {
     /* Sort descending by timestamp */
     merged.sort(function(a, b) { return b.t - a.t; });
 
-    /* Truncate: remove entries older than 3 hours */
-    var cutoff = Math.floor(Date.now() / 1000) - CACHE_DURATION;
+    /* Truncate: remove entries older than RETAIN_DURATION */
     var trimmed = [];
     for (i = 0; i < merged.length; i++) {
         if (merged[i].t >= cutoff) {
@@ -103,146 +228,566 @@ function mergeCache(cache, newReadings) {
 }
 
 /**
- * Encode readings into a byte array for bulk transfer.
- * Each reading is 6 bytes: int16 value (LE) + int32 timestamp (LE).
+ * Merge a fresh fetch of events since `since` into the event index: the
+ * fetch is authoritative for its window (so deleted treatments vanish),
+ * older events are kept. Result is sorted descending and trimmed to
+ * CACHE_DURATION.
  */
-function encodeReadingsToBytes(values, timestamps) {
-    var bytes = [];
-    for (var i = 0; i < values.length; i++) {
-        var value = values[i];
-        var ts = timestamps[i];
-        /* int16 little-endian (handle negative via & 0xFFFF) */
-        var v = value & 0xFFFF;
-        bytes.push(v & 0xFF);
-        bytes.push((v >> 8) & 0xFF);
-        /* int32 little-endian */
-        bytes.push(ts & 0xFF);
-        bytes.push((ts >> 8) & 0xFF);
-        bytes.push((ts >> 16) & 0xFF);
-        bytes.push((ts >> 24) & 0xFF);
+function mergeEvents(events, fetched, since) {
+    var cutoff = Math.floor(Date.now() / 1000) - CACHE_DURATION;
+    var merged = [];
+    var i;
+    for (i = 0; i < events.length; i++) {
+        if (events[i].t < since && events[i].t >= cutoff) merged.push(events[i]);
     }
-    return bytes;
+    for (i = 0; i < fetched.length; i++) {
+        if (fetched[i].t >= cutoff) merged.push(fetched[i]);
+    }
+    merged.sort(function(a, b) { return b.t - a.t || a.k - b.k; });
+    return merged;
 }
 
 /**
- * Send glucose data array to watch using bulk byte array transfer
+ * Select the newest Protocol.MAX_EVENTS events with start <= t < end
  */
-function sendGlucoseData(cache) {
-    if (!cache || cache.length === 0) {
-        console.log('No readings to send');
-        Pebble.sendAppMessage({ 'BG_COUNT': 0, 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }, function() {
-            isFetchInProgress = false;
-        }, function() {
-            isFetchInProgress = false;
+function selectEvents(events, start, end) {
+    var out = [];
+    for (var i = 0; i < events.length && out.length < Protocol.MAX_EVENTS; i++) {
+        if (events[i].t < start) break;
+        if (events[i].t < end) out.push(events[i]);
+    }
+    return out;
+}
+
+/**
+ * Estimate the source sample interval (seconds) as the median spacing of
+ * the newest readings, rounded to whole minutes.
+ */
+function sampleInterval(readings) {
+    var deltas = [];
+    for (var i = 1; i < readings.length && deltas.length < 24; i++) {
+        deltas.push(readings[i - 1].t - readings[i].t);
+    }
+    if (deltas.length === 0) return DEFAULT_SAMPLE_INTERVAL;
+
+    deltas.sort(function(a, b) { return a - b; });
+    var median = Math.round(deltas[deltas.length >> 1] / 60) * 60;
+    return median > 0 ? median : DEFAULT_SAMPLE_INTERVAL;
+}
+
+/**
+ * Decimate readings (sorted descending) to at most one per interval:
+ * readings in the same interval-aligned bucket are averaged and take the
+ * newest timestamp of the bucket.
+ */
+function decimate(readings, interval) {
+    var out = [];
+    var bucket = null;
+    var sum = 0;
+    var n = 0;
+    var newest = 0;
+
+    for (var i = 0; i < readings.length; i++) {
+        var b = Math.floor(readings[i].t / interval);
+        if (b !== bucket) {
+            if (n > 0) out.push({ v: Math.round(sum / n), t: newest });
+            bucket = b;
+            sum = 0;
+            n = 0;
+            newest = readings[i].t;
+        }
+        sum += readings[i].v;
+        n++;
+    }
+    if (n > 0) out.push({ v: Math.round(sum / n), t: newest });
+    return out;
+}
+
+/**
+ * Convert cached readings to the wire's units (x10 integers)
+ */
+function toWireReadings(readings, units) {
+    var out = [];
+    for (var i = 0; i < readings.length; i++) {
+        out.push({ v: convertBGValue(readings[i].v, units), t: readings[i].t });
+    }
+    return out;
+}
+
+/**
+ * Add the protocol version and the glucose axis mode from settings to a
+ * header message
+ */
+function addAxisSettings(msg) {
+    msg.PROTO_VERSION = Protocol.VERSION;
+    msg.BG_AXIS_AUTO = appSettings.AXIS_MODE === 'auto' ? 1 : 0;
+    return msg;
+}
+
+/**
+ * Add the battery plan thresholds from settings to a header message
+ */
+function addPowerSettings(msg) {
+    var saver = parseInt(appSettings.POWER_SAVER_PCT, 10);
+    var critical = parseInt(appSettings.POWER_CRITICAL_PCT, 10);
+    msg.POWER_SAVER_PCT = isNaN(saver) ? DEFAULT_POWER_SAVER_PCT : saver;
+    msg.POWER_CRITICAL_PCT = isNaN(critical) ? DEFAULT_POWER_CRITICAL_PCT : critical;
+    return msg;
+}
+
+/**
+ * Whether the settings have the phone draw the chart for the connected
+ * watch's platform
+ */
+function phoneRendersChart() {
+    var chosen = appSettings.PHONE_RENDER;
+    var info = Pebble.getActiveWatchInfo ? Pebble.getActiveWatchInfo() : null;
+    var index = info ? RENDER_PLATFORMS.indexOf(info.platform) : -1;
+    return !!(chosen && index >= 0 && chosen[index]);
+}
+
+/**
+ * The chart geometry the connected watch reported with its latest
+ * request, if it came from the same platform
+ */
+function watchLayout() {
+    var info = Pebble.getActiveWatchInfo ? Pebble.getActiveWatchInfo() : null;
+    try {
+        var saved = JSON.parse(window.localStorage.getItem(LAYOUT_KEY));
+        if (saved && info && saved.platform === info.platform) {
+            return saved.layout;
+        }
+    } catch (e) {
+        Log.error('Error loading chart layout: ' + e.message);
+    }
+    return null;
+}
+
+/**
+ * Remember the chart geometry sent with a watch request
+ */
+function saveWatchLayout(bytes) {
+    var layout = Protocol.decodeChartLayout(bytes);
+    var info = Pebble.getActiveWatchInfo ? Pebble.getActiveWatchInfo() : null;
+    if (!layout || !info) return;
+    try {
+        window.localStorage.setItem(LAYOUT_KEY, JSON.stringify({ platform: info.platform, layout: layout }));
+    } catch (e) {
+        Log.error('Error saving chart layout: ' + e.message);
+    }
+}
+
+/**
+ * Mark the current transfer finished and run whatever was queued behind it
+ */
+function finishTransfer() {
+    isFetchInProgress = false;
+
+    if (pendingPageEnd !== null) {
+        var pageEnd = pendingPageEnd;
+        pendingPageEnd = null;
+        sendHistoryPage(pageEnd);
+    } else if (pendingFetch) {
+        pendingFetch = false;
+        fetchGlucoseData();
+    }
+}
+
+/**
+ * Tell the watch there is no data (or, for a page request, nothing older).
+ * status says why when it is more than an empty range: BG_STATUS_FAILED
+ * keeps the watch's readings, BG_STATUS_EMPTY clears them.
+ */
+function sendNoData(pageEnd, status) {
+    var msg = addPowerSettings(addAxisSettings({ 'BG_COUNT': 0, 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }));
+    if (pageEnd) {
+        msg.BG_PAGE_END = pageEnd;
+    }
+    if (status) {
+        msg.BG_STATUS = status;
+    }
+    Pebble.sendAppMessage(msg, finishTransfer, finishTransfer);
+}
+
+/**
+ * Readings-range part of a payload key: count and end timestamps, which
+ * with the data generation pin down the selection
+ */
+function rangeKey(readings) {
+    if (readings.length === 0) return '0';
+    return readings.length + ':' + readings[0].t + ':' + readings[readings.length - 1].t;
+}
+
+/**
+ * Everything an encoded payload depends on besides the statistics: the
+ * protocol version, the data generation, the watch's platform, the
+ * settings in the header, the readings selected and, for live data, the
+ * time windows yesterday's trace, the sparkline and the chart are cut to
+ * and the chart mode (with the watch's layout when projecting)
+ */
+function payloadKey(readings, yesterday, pageEnd, drawn, layout, now) {
+    var info = Pebble.getActiveWatchInfo ? Pebble.getActiveWatchInfo() : null;
+    var settings = addPowerSettings(addAxisSettings({ 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }));
+    var parts = [
+        Protocol.VERSION,
+        loadGeneration(),
+        info ? info.platform : '',
+        JSON.stringify(settings),
+        pageEnd || 0,
+        rangeKey(readings)
+    ];
+    if (!pageEnd) {
+        parts.push(rangeKey(yesterday), Sparkline.end(now));
+        if (drawn || layout) {
+            parts.push(Render.viewEndAt(now));
+        }
+        parts.push(drawn ? 'drawn' : layout ? JSON.stringify(layout) : 'native');
+    }
+    return parts.join('|');
+}
+
+/**
+ * The encoded payload memoized under key, or null
+ */
+function loadPayload(key) {
+    if (payloadMemo === null) {
+        try {
+            payloadMemo = JSON.parse(window.localStorage.getItem(PAYLOAD_KEY)) || [];
+        } catch (e) {
+            Log.error('Error loading ' + PAYLOAD_KEY + ': ' + e.message);
+            payloadMemo = [];
+        }
+    }
+    for (var i = 0; i < payloadMemo.length; i++) {
+        if (payloadMemo[i].key === key) {
+            return payloadMemo[i];
+        }
+    }
+    return null;
+}
+
+/**
+ * Memoize an encoded payload, dropping the oldest beyond PAYLOAD_SLOTS and
+ * any from an older data generation
+ */
+function savePayload(payload) {
+    var generation = loadGeneration();
+    var kept = [payload];
+    for (var i = 0; i < payloadMemo.length && kept.length < PAYLOAD_SLOTS; i++) {
+        if (payloadMemo[i].generation === generation && payloadMemo[i].key !== payload.key) {
+            kept.push(payloadMemo[i]);
+        }
+    }
+    payloadMemo = kept;
+    try {
+        window.localStorage.setItem(PAYLOAD_KEY, JSON.stringify(payloadMemo));
+    } catch (e) {
+        Log.error('Error saving ' + PAYLOAD_KEY + ': ' + e.message);
+    }
+}
+
+/**
+ * Encode a transfer: the header (without statistics), the readings in
+ * BG_CHUNK pieces and, when the phone draws the chart, its encoding.
+ * Sources denser than MIN_SAMPLE_INTERVAL are decimated first; the header
+ * tells the watch the resulting interval for gap detection.
+ */
+function encodePayload(cache, fullCache, yesterdayRange, pageEnd, drawn, layout, now) {
+    var interval = sampleInterval(cache);
+    if (interval < MIN_SAMPLE_INTERVAL) {
+        cache = decimate(cache, MIN_SAMPLE_INTERVAL);
+        interval = MIN_SAMPLE_INTERVAL;
+    }
+
+    var bgUnits = appSettings.BG_UNITS || 'mg/dL';
+    var count = Math.min(cache.length, Protocol.MAX_READINGS);
+    var readings = toWireReadings(cache.slice(0, count), bgUnits);
+
+    if (Log.debug) {
+        Log.debug('Encoding ' + count + ' readings for the watch (' + bgUnits + ')');
+        Log.debug('First reading: ' + readings[0].v / 10 + ' ' + bgUnits + ' at ' + new Date(readings[0].t * 1000));
+        Log.debug('Last reading: ' + readings[count - 1].v / 10 + ' ' + bgUnits + ' at ' + new Date(readings[count - 1].t * 1000));
+    }
+
+    /* Header first */
+    var header = addPowerSettings(addAxisSettings({
+        'BG_COUNT': count,
+        'BG_UNITS': bgUnits,
+        'BG_INTERVAL': interval
+    }));
+    if (pageEnd) {
+        header.BG_PAGE_END = pageEnd;
+    }
+
+    /* Yesterday's trace rides along with live data */
+    var yesterday = decimate(yesterdayRange, Protocol.YESTERDAY_INTERVAL).slice(0, Protocol.YESTERDAY_MAX);
+    if (yesterday.length > 0) {
+        header.BG_YESTERDAY = Protocol.encodeReadings(toWireReadings(yesterday, bgUnits));
+    }
+
+    /* So does the 24 h sparkline for the strip under the chart */
+    if (!pageEnd) {
+        var sparkEnd = Sparkline.end(now);
+        header.SPARK_END = sparkEnd;
+        header.BG_SPARK = Protocol.encodeSparkColumns(Sparkline.build(fullCache, sparkEnd));
+    }
+
+    /* Treatments from the oldest reading sent up to the page end (or now):
+       the watch replaces its events in that range with these */
+    var events = selectEvents(loadEvents(), readings[count - 1].t, pageEnd || Infinity);
+    if (events.length > 0) {
+        header.BG_EVENTS = Protocol.encodeEvents(events);
+        if (Log.debug) Log.debug('With ' + events.length + ' treatment events');
+    }
+
+    /* The live chart ready-drawn, after the readings, where the settings
+       ask for it; the watch blits it instead of drawing */
+    var chartRle = null;
+    if (drawn) {
+        var viewEnd = Render.viewEndAt(now);
+        chartRle = Render.encode(Render.render({
+            readings: readings,
+            yesterday: toWireReadings(yesterday, bgUnits),
+            events: events,
+            interval: interval,
+            isMmol: bgUnits === 'mmol/L',
+            axisAuto: appSettings.AXIS_MODE === 'auto',
+            viewEnd: viewEnd
+        }));
+        header.CHART_SIZE = chartRle.length;
+        header.CHART_END = viewEnd;
+        if (Log.debug) Log.debug('With the chart drawn: ' + chartRle.length + ' bytes');
+    }
+
+    /* Otherwise the live trace projected to the watch's screen, where the
+       settings ask for it and the watch has reported its layout; the watch
+       draws it without projecting */
+    if (layout) {
+        var pointsEnd = Render.viewEndAt(now);
+        var projected = Project.project(layout, {
+            readings: readings,
+            yesterday: toWireReadings(yesterday, bgUnits),
+            interval: interval,
+            isMmol: bgUnits === 'mmol/L',
+            axisAuto: appSettings.AXIS_MODE === 'auto',
+            viewEnd: pointsEnd
         });
+        header.POINTS_END = pointsEnd;
+        header.POINTS_AXIS = projected.axis;
+        header.BG_POINTS = projected.points;
+        if (projected.yesterday.length > 0) {
+            header.BG_YESTERDAY_POINTS = projected.yesterday;
+        }
+        if (projected.labels.length > 0) {
+            header.BG_LABELS = projected.labels;
+        }
+        if (Log.debug) Log.debug('With the chart projected: ' + projected.points.length / Protocol.BYTES_PER_CHART_POINT + ' points');
+    }
+
+    /* Then the readings, MAX_READINGS_PER_CHUNK to a message */
+    var chunks = [];
+    for (var i = 0; i < count; i += MAX_READINGS_PER_CHUNK) {
+        chunks.push({
+            index: i,
+            bytes: Protocol.encodeReadings(readings.slice(i, i + MAX_READINGS_PER_CHUNK))
+        });
+    }
+
+    return { header: header, chunks: chunks, chart: chartRle };
+}
+
+/**
+ * Send glucose data array to watch using bulk byte array transfer.
+ * When pageEnd is given the readings answer a history page request.
+ * The encoded transfer is memoized (see payloadKey()), so a repeated
+ * request for unchanged data, settings and watch skips straight to
+ * sending; only the statistics are worked out each time.
+ */
+function sendGlucoseData(cache, pageEnd) {
+    if (!cache || cache.length === 0) {
+        if (Log.info) Log.info('No readings to send');
+        sendNoData(pageEnd, !pageEnd && loadCache().length === 0 ? Protocol.BG_STATUS_EMPTY : 0);
         return;
     }
 
-    var bgUnits = appSettings.BG_UNITS || 'mg/dL';
-    var count = Math.min(cache.length, MAX_READINGS);
+    /* Live transfers carry context from the whole cache */
+    var now = Math.floor(Date.now() / 1000);
+    var fullCache = pageEnd ? null : loadCache();
+    var shift = Protocol.YESTERDAY_SHIFT;
+    var yesterdayRange = pageEnd ? [] : selectRange(fullCache, now - shift - PAGE_DURATION, now - shift);
+    var drawn = !pageEnd && phoneRendersChart();
+    var layout = !pageEnd && !drawn && appSettings.PHONE_PROJECT ? watchLayout() : null;
 
-    /* Prepare arrays for values and timestamps */
-    var values = [];
-    var timestamps = [];
+    var key = payloadKey(cache, yesterdayRange, pageEnd, drawn, layout, now);
+    var payload = loadPayload(key);
+    if (payload) {
+        if (Log.debug) Log.debug('Serving the encoded payload from memo');
+    } else {
+        payload = encodePayload(cache, fullCache, yesterdayRange, pageEnd, drawn, layout, now);
+        payload.key = key;
+        payload.generation = loadGeneration();
+        savePayload(payload);
+    }
 
-    for (var i = 0; i < count; i++) {
-        values.push(convertBGValue(cache[i].v, bgUnits));
-        timestamps.push(cache[i].t);
+    var header = {};
+    for (var field in payload.header) {
+        if (payload.header.hasOwnProperty(field)) {
+            header[field] = payload.header[field];
+        }
     }
 
-    console.log('Sending ' + count + ' readings to watch (' + bgUnits + ')');
-    console.log('First reading: ' + values[0] / 10 + ' ' + bgUnits + ' at ' + new Date(timestamps[0] * 1000));
-    console.log('Last reading: ' + values[count - 1] / 10 + ' ' + bgUnits + ' at ' + new Date(timestamps[count - 1] * 1000));
+    /* Statistics ride along with live data when any value changed */
+    var statsBytes = null;
+    if (!pageEnd) {
+        var bgUnits = header.BG_UNITS;
+        var stats = loadStats();
+        stats.advance(now);
+        statsBytes = Protocol.encodeStatsWindows(stats.summary(function(mgdl) {
+            return convertBGValue(mgdl, bgUnits);
+        }));
+        if (statsBytes.join() !== lastStatsSent) {
+            header.BG_STATS = statsBytes;
+        }
+    }
 
-    /* Send header first */
-    Pebble.sendAppMessage({
-        'BG_COUNT': count,
-        'BG_UNITS': bgUnits
-    }, function() {
-        console.log('Sent BG count: ' + count);
+    var chartRle = payload.chart;
+    Pebble.sendAppMessage(header, function() {
+        if (Log.debug) Log.debug('Sent BG count: ' + header.BG_COUNT);
+        if (header.BG_STATS) {
+            lastStatsSent = statsBytes.join();
+        }
         /* Send chunks after header ACK */
-        sendChunks(values, timestamps, 0, 0);
+        sendChunks(payload.chunks, 0, 0, chartRle ? function() {
+            sendChartBitmap(chartRle, 0, 0);
+        } : finishTransfer);
     }, function(e) {
-        console.error('Failed to send BG count: ' + (e && e.error ? e.error.message : 'unknown'));
-        isFetchInProgress = false;
+        Log.error('Failed to send BG count: ' + (e && e.error ? e.error.message : 'unknown'));
+        finishTransfer();
     });
 }
 
 /**
- * Send readings in chunks via byte array
+ * Send the weekly heatmap: hourly means for the HEATMAP_DAYS local days
+ * ending today, read from the rolling statistics' buckets. Each cell is
+ * the bucket holding the start of its local hour, so rows follow local
+ * midnight across DST changes; hours still to come read as "no readings".
+ * The buckets are whole UTC hours, so in half-hour time zones each cell
+ * covers half an hour either side of the start of its local hour.
  */
-function sendChunks(values, timestamps, startIndex, retries) {
-    if (startIndex >= values.length) {
-        console.log('All data sent successfully');
-        isFetchInProgress = false;
-        return;
+function sendHeatmap() {
+    var bgUnits = appSettings.BG_UNITS || 'mg/dL';
+    var start = new Date();
+    start.setHours(0, 0, 0, 0);
+    start.setDate(start.getDate() - (Protocol.HEATMAP_DAYS - 1));
+    var startSec = Math.floor(start.getTime() / 1000);
+
+    var stats = loadStats();
+    stats.advance(Math.floor(Date.now() / 1000));
+    var cells = [];
+    for (var i = 0; i < Protocol.HEATMAP_CELLS; i++) {
+        var hour = new Date(start.getFullYear(), start.getMonth(),
+                            start.getDate() + Math.floor(i / 24), i % 24);
+        var mean = stats.hourlyMeans(Math.floor(hour.getTime() / 3600000), 1)[0];
+        cells.push({ v: mean > 0 ? convertBGValue(mean, bgUnits) : 0 });
     }
 
-    var remaining = values.length - startIndex;
-    var chunkSize = Math.min(remaining, MAX_READINGS_PER_CHUNK);
+    Pebble.sendAppMessage({
+        'PROTO_VERSION': Protocol.VERSION,
+        'BG_UNITS': bgUnits,
+        'HEATMAP_START': startSec,
+        'BG_HEATMAP': Protocol.encodeHeatmapCells(cells)
+    }, function() {
+        if (Log.info) Log.info('Sent heatmap from ' + start);
+    }, function(e) {
+        Log.error('Failed to send heatmap: ' + (e && e.error ? e.error.message : 'unknown'));
+    });
+}
 
-    var chunkValues = values.slice(startIndex, startIndex + chunkSize);
-    var chunkTimestamps = timestamps.slice(startIndex, startIndex + chunkSize);
-    var bytes = encodeReadingsToBytes(chunkValues, chunkTimestamps);
+/**
+ * Send the encoded reading chunks in turn, then continue with done
+ */
+function sendChunks(chunks, i, retries, done) {
+    if (i >= chunks.length) {
+        if (Log.debug) Log.debug('All data sent successfully');
+        done();
+        return;
+    }
 
     var msg = {
-        'BG_CHUNK': bytes,
-        'BG_INDEX': startIndex
+        'BG_CHUNK': chunks[i].bytes,
+        'BG_INDEX': chunks[i].index
     };
 
     Pebble.sendAppMessage(msg, function() {
-        console.log('Sent chunk at index ' + startIndex + ', size ' + chunkSize);
+        if (Log.debug) Log.debug('Sent chunk at index ' + msg.BG_INDEX + ', ' + msg.BG_CHUNK.length + ' bytes');
         /* Send next chunk */
-        sendChunks(values, timestamps, startIndex + chunkSize, 0);
+        sendChunks(chunks, i + 1, 0, done);
     }, function(e) {
-        console.error('Failed to send chunk at index ' + startIndex + ': ' + (e && e.error ? e.error.message : 'unknown'));
+        Log.error('Failed to send chunk at index ' + msg.BG_INDEX + ': ' + (e && e.error ? e.error.message : 'unknown'));
         if (retries < 3) {
             setTimeout(function() {
-                sendChunks(values, timestamps, startIndex, retries + 1);
+                sendChunks(chunks, i, retries + 1, done);
             }, 500);
         } else {
-            console.error('Max retries reached for chunk at index ' + startIndex);
-            isFetchInProgress = false;
+            Log.error('Max retries reached for chunk at index ' + msg.BG_INDEX);
+            finishTransfer();
         }
     });
 }
 
 /**
- * Fetch glucose readings from Dexcom
+ * Send the phone-rendered chart's encoding in REMOTE_CHUNK byte pieces
  */
-function fetchGlucoseData() {
-    if (isFetchInProgress) {
-        console.log('Fetch already in progress, skipping');
+function sendChartBitmap(rle, offset, retries) {
+    if (offset >= rle.length) {
+        if (Log.debug) Log.debug('Chart bitmap sent');
+        finishTransfer();
         return;
     }
-    isFetchInProgress = true;
-
-    console.log('Fetching glucose data...');
 
-    if (!appSettings.DEX_LOGIN || !appSettings.DEX_PASSWORD) {
-        console.error('No Dexcom credentials configured');
-        Pebble.sendAppMessage({ 'BG_COUNT': 0, 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }, function() {
-            isFetchInProgress = false;
-        }, function() {
-            isFetchInProgress = false;
-        });
-        return;
-    }
+    var msg = {
+        'CHART_RLE': rle.slice(offset, offset + Protocol.REMOTE_CHUNK),
+        'CHART_OFFSET': offset
+    };
+    Pebble.sendAppMessage(msg, function() {
+        sendChartBitmap(rle, offset + msg.CHART_RLE.length, 0);
+    }, function(e) {
+        Log.error('Failed to send chart at offset ' + offset + ': ' + (e && e.error ? e.error.message : 'unknown'));
+        if (retries < 3) {
+            setTimeout(function() {
+                sendChartBitmap(rle, offset, retries + 1);
+            }, 500);
+        } else {
+            finishTransfer();
+        }
+    });
+}
 
+/**
+ * Create a Dexcom client that merges fetched readings into the cache and
+ * hands the updated cache to onCache. Errors are reported to the watch as
+ * a failed fetch (BG_STATUS_FAILED, for pageEnd's page when given), or
+ * handed to onError when given.
+ */
+function createDexcom(onCache, pageEnd, onError) {
     var accountId = window.localStorage.getItem('dexcom_account_id');
     var sessionId = window.localStorage.getItem('dexcom_session_id');
-
-    var cache = loadCache();
+    /* Region the account was found in; 'auto' probes for it on first login */
+    var cachedRegion = window.localStorage.getItem('dexcom_region');
+    var setting = appSettings.DEX_REGION || 'auto';
+    var region = setting === 'auto' ? cachedRegion : setting;
 
     var dex = new Dexcom(
         appSettings.DEX_LOGIN,
         appSettings.DEX_PASSWORD,
         function(readings) {
-            console.log('Received ' + readings.length + ' readings from Dexcom');
+            if (Log.info) Log.info('Received ' + readings.length + ' readings from Dexcom');
+            lastFetchTime = Date.now();
 
             /* Cache session IDs */
             window.localStorage.setItem('dexcom_account_id', dex.accountId);
             window.localStorage.setItem('dexcom_session_id', dex.sessionId);
+            window.localStorage.setItem('dexcom_region', dex.region);
 
             /* Convert Dexcom readings to cache format {v, t} */
             var newEntries = [];
@@ -254,29 +799,140 @@ function fetchGlucoseData() {
             }
 
             /* Merge into cache */
-            cache = mergeCache(cache, newEntries);
+            var stats = loadStats();
+            var cache = mergeCache(loadCache(), newEntries, stats);
             saveCache(cache);
+            saveStats(stats);
 
-            /* Send to watch */
-            sendGlucoseData(cache);
+            onCache(cache);
         },
-        appSettings.DEX_REGION || 'ous',
+        region,
         function(error) {
-            console.error('Dexcom fetch failed: ' + error);
-            Pebble.sendAppMessage({ 'BG_COUNT': 0, 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }, function() {
-                isFetchInProgress = false;
-            }, function() {
-                isFetchInProgress = false;
-            });
+            Log.error('Dexcom fetch failed: ' + error);
+            if (onError) {
+                onError(error);
+            } else {
+                sendNoData(pageEnd, Protocol.BG_STATUS_FAILED);
+            }
         }
     );
 
-    /* Restore session if available */
-    if (accountId && sessionId) {
+    /* Restore session if available, and from the region in use (IDs
+       cached before regions were, with an explicit region, count) */
+    if (accountId && sessionId && region && (!cachedRegion || cachedRegion === region)) {
         dex.accountId = accountId;
         dex.sessionId = sessionId;
     }
 
+    return dex;
+}
+
+/**
+ * Log the watch's energy counters next to the phone's HTTP counters,
+ * both as hourly rates.
+ * Counters: redraws, render ms, inbox messages, inbox bytes, outbox sends,
+ * wakeups.
+ */
+function logEnergyReport(bytes) {
+    var report = Protocol.decodeEnergyReport(bytes);
+    if (!report) {
+        Log.error('Malformed energy report (' + (bytes ? bytes.length : 0) + ' bytes)');
+        return;
+    }
+    var fields = [report.elapsed].concat(report.counters);
+    var watchHours = Math.max(fields[0], 60) / 3600;
+    var rate = function(n, hours) { return (n / hours).toFixed(1); };
+
+    var http = Dexcom.stats;
+    var phoneHours = Math.max((Date.now() - http.since) / 1000, 60) / 3600;
+
+    console.log('Energy report over ' + Math.round(fields[0] / 60) + ' min (per hour): ' +
+        'redraws ' + rate(fields[1], watchHours) +
+        ', render ms ' + rate(fields[2], watchHours) +
+        ', inbox msgs ' + rate(fields[3], watchHours) +
+        ', inbox bytes ' + rate(fields[4], watchHours) +
+        ', outbox sends ' + rate(fields[5], watchHours) +
+        ', wakeups ' + rate(fields[6], watchHours));
+    console.log('Phone HTTP over ' + Math.round(phoneHours * 60) + ' min (per hour): ' +
+        'requests ' + rate(http.requests, phoneHours) +
+        ', bytes sent ' + rate(http.bytesSent, phoneHours) +
+        ', bytes received ' + rate(http.bytesReceived, phoneHours));
+}
+
+/**
+ * Refresh the treatment event index from Nightscout, if configured, then
+ * call done. The first fetch covers CACHE_DURATION; later ones re-read
+ * one PAGE_DURATION before the previous fetch to pick up edits. Failures
+ * are logged and leave the index as it was.
+ */
+function refreshEvents(done) {
+    if (!appSettings.NS_URL) {
+        done();
+        return;
+    }
+
+    var now = Math.floor(Date.now() / 1000);
+    var fetched = parseInt(window.localStorage.getItem(EVENTS_FETCHED_KEY), 10) || 0;
+    var since = Math.max(fetched - PAGE_DURATION, now - CACHE_DURATION);
+
+    new Nightscout(appSettings.NS_URL, appSettings.NS_TOKEN).getEvents(since, function(events) {
+        if (Log.debug) Log.debug('Received ' + events.length + ' treatment events');
+        saveArray(EVENTS_KEY, mergeEvents(loadEvents(), events, since));
+        window.localStorage.setItem(EVENTS_FETCHED_KEY, String(now));
+        done();
+    }, function(error) {
+        Log.error('Treatments fetch failed: ' + error);
+        done();
+    });
+}
+
+/**
+ * Fetch glucose readings from Dexcom
+ */
+function fetchGlucoseData() {
+    if (isFetchInProgress) {
+        if (Log.debug) Log.debug('Fetch already in progress, queueing');
+        pendingFetch = true;
+        return;
+    }
+    isFetchInProgress = true;
+
+    if (Log.debug) Log.debug('Fetching glucose data...');
+
+    if (!appSettings.DEX_LOGIN || !appSettings.DEX_PASSWORD) {
+        Log.error('No Dexcom credentials configured');
+        sendNoData(null, Protocol.BG_STATUS_FAILED);
+        return;
+    }
+
+    var cache = loadCache();
+
+    /* On a low battery the watch asks less often; also skip the network
+       for requests in between (relaunches, reconnects) and answer from
+       the cache until the plan's interval has passed. */
+    if (watchRefreshMinutes > DEFAULT_REFRESH_MINUTES && cache.length > 0 &&
+        Date.now() - lastFetchTime < (watchRefreshMinutes - 1) * 60000) {
+        if (Log.debug) Log.debug('Battery plan (' + watchRefreshMinutes + ' min): serving cache');
+        sendGlucoseData(selectLive(cache));
+        return;
+    }
+
+    refreshEvents(function() {
+        fetchReadings(cache);
+    });
+}
+
+/**
+ * Fetch the readings missing from the cache (or a full page) and send the
+ * live window to the watch
+ */
+function fetchReadings(cache) {
+    var dex = createDexcom(function(updated) {
+        /* Send to watch */
+        sendGlucoseData(selectLive(updated));
+    });
+    var interval = sampleInterval(cache);
+
     try {
         if (cache.length > 0) {
             /* Incremental fetch: only get new readings since newest cached */
@@ -285,41 +941,215 @@ function fetchGlucoseData() {
                 minutesSinceNewest = 10;
             }
             var fetchMinutes = minutesSinceNewest + 5;
-            var maxCount = Math.min(Math.ceil(fetchMinutes / 5) + 1, MAX_READINGS);
-            console.log('Incremental fetch: ' + fetchMinutes + ' minutes, max ' + maxCount + ' readings');
+            var maxCount = Math.min(Math.ceil(fetchMinutes * 60 / interval) + 1, MAX_HISTORY_COUNT);
+            if (Log.debug) Log.debug('Incremental fetch: ' + fetchMinutes + ' minutes, max ' + maxCount + ' readings');
             dex.getGlucoseReadings(fetchMinutes, maxCount);
         } else {
             /* Full fetch */
-            console.log('Full fetch: 180 minutes, 36 readings');
-            dex.getGlucoseReadings(180, 36);
+            var fullCount = Math.min(Math.ceil(PAGE_DURATION / interval), MAX_HISTORY_COUNT);
+            if (Log.debug) Log.debug('Full fetch: ' + PAGE_DURATION / 60 + ' minutes, ' + fullCount + ' readings');
+            dex.getGlucoseReadings(PAGE_DURATION / 60, fullCount);
         }
     } catch (error) {
-        console.error('Error fetching glucose: ' + error.message);
-        Pebble.sendAppMessage({ 'BG_COUNT': 0, 'BG_UNITS': appSettings.BG_UNITS || 'mg/dL' }, function() {
-            isFetchInProgress = false;
-        }, function() {
-            isFetchInProgress = false;
-        });
+        Log.error('Error fetching glucose: ' + error.message);
+        sendNoData(null, Protocol.BG_STATUS_FAILED);
+    }
+}
+
+/**
+ * Answer a tap refresh: outside the battery plan's schedule, ask Dexcom
+ * for the newest reading alone and send just that (BG_HEAD). On errors
+ * the watch simply keeps what it has.
+ */
+function fetchHead() {
+    if (isFetchInProgress) {
+        if (Log.debug) Log.debug('Transfer in progress, queueing a fetch for the tap refresh');
+        pendingFetch = true;
+        return;
+    }
+    if (!appSettings.DEX_LOGIN || !appSettings.DEX_PASSWORD) {
+        return;
+    }
+    isFetchInProgress = true;
+
+    var dex = createDexcom(sendHead, null, finishTransfer);
+    try {
+        dex.getGlucoseReadings(CACHE_DURATION / 60, 1);
+    } catch (error) {
+        Log.error('Error fetching the newest reading: ' + error.message);
+        finishTransfer();
+    }
+}
+
+/**
+ * Send the newest cached reading on its own
+ */
+function sendHead(cache) {
+    if (cache.length === 0) {
+        finishTransfer();
+        return;
+    }
+    var head = toWireReadings(cache.slice(0, 1), appSettings.BG_UNITS || 'mg/dL');
+    Pebble.sendAppMessage({
+        'PROTO_VERSION': Protocol.VERSION,
+        'BG_HEAD': Protocol.encodeReadings(head)
+    }, function() {
+        if (Log.debug) Log.debug('Sent the newest reading: ' + head[0].v / 10 + ' at ' + head[0].t);
+        finishTransfer();
+    }, function(e) {
+        Log.error('Failed to send the newest reading: ' + (e && e.error ? e.error.message : 'unknown'));
+        finishTransfer();
+    });
+}
+
+/**
+ * Index of the newest reading with t <= ts in a cache sorted descending
+ * (binary search); cache.length when every reading is newer
+ */
+function lowerIndex(cache, ts) {
+    var lo = 0;
+    var hi = cache.length;
+    while (lo < hi) {
+        var mid = (lo + hi) >> 1;
+        if (cache[mid].t > ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Select the cached readings with start < t <= end
+ */
+function selectRange(cache, start, end) {
+    return cache.slice(lowerIndex(cache, end), lowerIndex(cache, start));
+}
+
+/**
+ * Select the cached readings in the live window (the last PAGE_DURATION)
+ */
+function selectLive(cache) {
+    var now = Math.floor(Date.now() / 1000);
+    return selectRange(cache, now - PAGE_DURATION, Infinity);
+}
+
+/**
+ * Select one page of cached readings older than pageEnd: PAGE_DURATION
+ * worth, starting at the newest such reading (so gaps are skipped over)
+ */
+function selectPage(cache, pageEnd) {
+    var page = [];
+    var start = null;
+    for (var i = 0; i < cache.length; i++) {
+        if (cache[i].t >= pageEnd) continue;
+        if (start === null) start = cache[i].t - PAGE_DURATION;
+        if (cache[i].t <= start) break;
+        page.push(cache[i]);
+    }
+    return page;
+}
+
+/**
+ * Answer a watch history request with the page of readings older than
+ * pageEnd. Served from the cache when it already reaches back far enough;
+ * otherwise Dexcom is asked for everything back to the start of the page.
+ */
+function sendHistoryPage(pageEnd) {
+    if (isFetchInProgress) {
+        if (Log.debug) Log.debug('Transfer in progress, queueing history page before ' + pageEnd);
+        pendingPageEnd = pageEnd;
+        return;
+    }
+    isFetchInProgress = true;
+
+    var cache = loadCache();
+    var page = selectPage(cache, pageEnd);
+    var now = Math.floor(Date.now() / 1000);
+    var pageStart = pageEnd - PAGE_DURATION;
+    var covered = cache.length > 0 && cache[cache.length - 1].t <= pageStart;
+
+    if (covered || pageStart < now - CACHE_DURATION ||
+        !appSettings.DEX_LOGIN || !appSettings.DEX_PASSWORD) {
+        if (Log.debug) Log.debug('Serving history page before ' + pageEnd + ' from cache (' + page.length + ' readings)');
+        sendGlucoseData(page, pageEnd);
+        return;
+    }
+
+    var dex = createDexcom(function(updated) {
+        sendGlucoseData(selectPage(updated, pageEnd), pageEnd);
+    }, pageEnd);
+
+    try {
+        var minutes = Math.min(Math.ceil((now - pageStart) / 60), CACHE_DURATION / 60);
+        var maxCount = Math.min(Math.ceil(minutes * 60 / sampleInterval(cache)) + 1, MAX_HISTORY_COUNT);
+        if (Log.debug) Log.debug('History fetch: ' + minutes + ' minutes, max ' + maxCount + ' readings');
+        dex.getGlucoseReadings(minutes, maxCount);
+    } catch (error) {
+        Log.error('Error fetching history: ' + error.message);
+        sendNoData(pageEnd, Protocol.BG_STATUS_FAILED);
     }
 }
 
 // Listen for when the watchface is opened
 Pebble.addEventListener('ready', function() {
-    console.log('PebbleKit JS ready!');
+    if (Log.info) Log.info('PebbleKit JS ready!');
     appSettings = getSettings();
     fetchGlucoseData();
 });
 
 // Listen for messages from the watch
 Pebble.addEventListener('appmessage', function(e) {
-    console.log('AppMessage received from watch');
-    appSettings = getSettings();
-    fetchGlucoseData();
+    if (Log.debug) Log.debug('AppMessage received from watch');
+    if (!e.payload || e.payload.PROTO_VERSION !== Protocol.VERSION) {
+        /* Watch and phone were built from different schemas: tell the
+           watch, which shows an update prompt, and send no data */
+        Log.error('Protocol mismatch: watch ' + (e.payload && e.payload.PROTO_VERSION) +
+            ', phone ' + Protocol.VERSION);
+        Pebble.sendAppMessage({ 'PROTO_VERSION': Protocol.VERSION, 'BG_COUNT': 0 });
+        return;
+    }
+    if (e.payload.HEATMAP_REQUEST) {
+        sendHeatmap();
+        return;
+    }
+    if (e.payload.ENERGY_REPORT) {
+        logEnergyReport(e.payload.ENERGY_REPORT);
+        return;
+    }
+    if (e.payload.POWER_REFRESH_MIN) {
+        watchRefreshMinutes = e.payload.POWER_REFRESH_MIN;
+    }
+    if (e.payload.CHART_LAYOUT) {
+        saveWatchLayout(e.payload.CHART_LAYOUT);
+    }
+    var pageEnd = e.payload.BG_PAGE_END;
+    if (pageEnd) {
+        sendHistoryPage(pageEnd);
+    } else if (e.payload.BG_DATA === Protocol.BG_DATA_HEAD) {
+        fetchHead();
+    } else {
+        fetchGlucoseData();
+    }
+});
+
+// Listen for when the settings page is requested
+Pebble.addEventListener('showConfiguration', function() {
+    Pebble.openURL(getClay().generateUrl());
 });
 
 // Listen for when settings are closed
-Pebble.addEventListener('webviewclosed', function() {
-    console.log('Settings closed');
+Pebble.addEventListener('webviewclosed', function(e) {
+    if (Log.info) Log.info('Settings closed');
+    if (e && e.response) {
+        try {
+            /* Stores the submitted settings in localStorage ('clay-settings') */
+            getClay().getSettings(e.response, false);
+        } catch (err) {
+            Log.error('Error reading settings response: ' + err.message);
+        }
+    }
     appSettings = getSettings();
     fetchGlucoseData();
 });
@@ -0,0 +1,37 @@
+// Leveled logging for PebbleKit JS
+// ES5 compatible version
+//
+// Log.error, Log.warn, Log.info and Log.debug log through console at
+// their level, or are null when the level is off. Guard each call so the
+// message is not even built when it would be dropped:
+//
+//     if (Log.debug) Log.debug('Sent ' + count + ' readings');
+//
+// Log.error is always on. Release builds keep errors and warnings; a
+// LOG_LEVEL=info or LOG_LEVEL=debug build starts PebbleKit JS from an
+// entry that raises the level (see wscript).
+
+var LEVELS = { error: 1, warn: 2, info: 3, debug: 4 };
+var DEFAULT_LEVEL = 'warn';
+
+var Log = {
+    error: function(message) { console.error(message); },
+    warn: null,
+    info: null,
+    debug: null
+};
+
+/**
+ * Turn the loggers at and below a level on, and those above it off
+ * @param {string} name - 'error', 'warn', 'info' or 'debug'
+ */
+Log.setLevel = function(name) {
+    var level = LEVELS[name] || LEVELS[DEFAULT_LEVEL];
+    Log.warn = level >= LEVELS.warn ? function(message) { console.warn(message); } : null;
+    Log.info = level >= LEVELS.info ? function(message) { console.log(message); } : null;
+    Log.debug = level >= LEVELS.debug ? function(message) { console.log(message); } : null;
+};
+
+Log.setLevel(DEFAULT_LEVEL);
+
+module.exports = Log;
@@ -0,0 +1,93 @@
+// Nightscout treatments client
+// ES5 compatible version
+
+var Dexcom = require('./dexcom');
+
+var TREATMENTS_ENDPOINT = '/api/v1/treatments.json';
+var MAX_TREATMENTS = 200;
+var REQUEST_TIMEOUT_MS = 15000;
+
+var EVENT_INSULIN = 1; /* amount in 0.1 U */
+var EVENT_CARBS = 2;   /* amount in grams */
+
+/**
+ * Nightscout constructor
+ * @param {string} baseUrl - Nightscout site URL (e.g. https://my.site)
+ * @param {string} token - Access token (optional)
+ */
+function Nightscout(baseUrl, token) {
+    this.baseUrl = String(baseUrl).replace(/\/+$/, '');
+    this.token = token || '';
+}
+
+/**
+ * Convert one Nightscout treatment into chart events. A meal bolus
+ * carries both insulin and carbs and becomes two events.
+ * @param {Object} treatment - Treatment record
+ * @returns {Array} Events {t, k, a}
+ */
+Nightscout.prototype.toEvents = function(treatment) {
+    var ms = treatment.mills || Date.parse(treatment.created_at);
+    if (!ms) return [];
+
+    var t = Math.floor(ms / 1000);
+    var events = [];
+    var insulin = parseFloat(treatment.insulin);
+    var carbs = parseFloat(treatment.carbs);
+    if (insulin > 0) {
+        events.push({ t: t, k: EVENT_INSULIN, a: Math.min(Math.round(insulin * 10), 255) });
+    }
+    if (carbs > 0) {
+        events.push({ t: t, k: EVENT_CARBS, a: Math.min(Math.round(carbs), 255) });
+    }
+    return events;
+};
+
+/**
+ * Fetch the insulin and carb events since a time
+ * @param {number} since - Unix time (seconds) of the oldest event wanted
+ * @param {Function} onResults - Called with the events (unsorted)
+ * @param {Function} onError - Called with an error message
+ */
+Nightscout.prototype.getEvents = function(since, onResults, onError) {
+    var self = this;
+    var url = this.baseUrl + TREATMENTS_ENDPOINT +
+        '?find[created_at][$gte]=' + encodeURIComponent(new Date(since * 1000).toISOString()) +
+        '&count=' + MAX_TREATMENTS;
+    if (this.token) {
+        url += '&token=' + encodeURIComponent(this.token);
+    }
+
+    var req = new XMLHttpRequest();
+    req.open('GET', url, true);
+    req.setRequestHeader('Accept', 'application/json');
+    req.timeout = REQUEST_TIMEOUT_MS;
+
+    req.onload = function() {
+        Dexcom.stats.bytesReceived += (req.responseText || '').length;
+        if (req.status !== 200) {
+            onError('HTTP ' + req.status);
+            return;
+        }
+        try {
+            var treatments = JSON.parse(req.responseText);
+            var events = [];
+            for (var i = 0; i < treatments.length; i++) {
+                events = events.concat(self.toEvents(treatments[i]));
+            }
+            onResults(events);
+        } catch (e) {
+            onError('Bad treatments response: ' + e.message);
+        }
+    };
+    req.onerror = function() { onError('Network error'); };
+    req.ontimeout = function() { onError('Timeout'); };
+
+    Dexcom.stats.requests++;
+    req.send(null);
+};
+
+Nightscout.EVENT_INSULIN = EVENT_INSULIN;
+Nightscout.EVENT_CARBS = EVENT_CARBS;
+
+module.exports = Nightscout;
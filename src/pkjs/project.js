@@ -0,0 +1,157 @@
+// Phone-side projection for the projected-points message mode
+// ES5 compatible version
+//
+// Maps the live readings to the watch's screen with the geometry the watch
+// reported in its request (CHART_LAYOUT), exactly as draw_glucose_lines()
+// and draw_extremum_labels() in src/c/main.c would, and packs the result:
+// uint8 x/y per point with segment-break and dot flags, plus the extremum
+// label anchors. The watch then draws straight from these, with no
+// projection, division or gap logic of its own.
+
+var Axis = require('./axis');
+var Protocol = require('./protocol.auto');
+
+var MAX_GAP_INTERVALS = 2;
+var LABEL_OFFSET = 4;  /* Gap between an extremum dot and its label box */
+
+var trunc = Axis.trunc;
+
+/** Screen geometry of a ChartLayout */
+function Geometry(layout) {
+    this.left = layout.chart_x + layout.padding;
+    this.right = layout.chart_x + layout.chart_w - layout.padding;
+    this.top = layout.chart_y + layout.padding;
+    this.bottom = layout.chart_y + layout.chart_h - layout.padding;
+    this.rightEdge = layout.chart_x + layout.chart_w;
+    this.secondsPerPixel = layout.seconds_per_pixel;
+    this.labelW = layout.label_w;
+    this.labelH = layout.label_h;
+}
+
+Geometry.prototype.x = function(v, axis) {
+    return this.left + trunc((v - axis.minBg) * (this.right - this.left) / axis.range);
+};
+
+Geometry.prototype.y = function(ts, viewEnd) {
+    return this.bottom - trunc((viewEnd - ts) / this.secondsPerPixel);
+};
+
+function clamp(v, lo, hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+/** Index of the first reading with t <= ts (readings newest first) */
+function lowerBound(readings, ts) {
+    var lo = 0;
+    var hi = readings.length;
+    while (lo < hi) {
+        var mid = (lo + hi) >> 1;
+        if (readings[mid].t > ts) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Points of one trace: the visible readings plus a neighbour each side,
+ * newest first. A point is flagged BREAK when no segment joins it to the
+ * point before it, and DOT when it is a visible reading.
+ */
+function projectSeries(geo, readings, shift, maxGap, axis, viewEnd) {
+    var points = [];
+    if (readings.length === 0) return points;
+    var first = lowerBound(readings, viewEnd - shift);
+    var end = lowerBound(readings, viewEnd - shift - Protocol.VIEW_SECONDS - 1);
+    var lo = first > 0 ? first - 1 : first;
+    var hi = end < readings.length ? end : end - 1;
+    var prevTs = 0;
+    for (var i = lo; i <= hi && points.length < Protocol.POINTS_MAX; i++) {
+        var ts = readings[i].t + shift;
+        var flags = 0;
+        if (i === lo || prevTs - ts > maxGap) flags |= Protocol.POINT_BREAK;
+        if (i >= first && i < end) flags |= Protocol.POINT_DOT;
+        points.push({
+            x: clamp(geo.x(readings[i].v, axis), geo.left, geo.right),
+            y: clamp(geo.y(ts, viewEnd), geo.top, geo.bottom),
+            f: flags
+        });
+        prevTs = ts;
+    }
+    return points;
+}
+
+/** Minimum and maximum label anchors, placed as draw_extremum_labels() */
+function projectLabels(geo, readings, first, end, axis, viewEnd) {
+    if (end - first < 1) return [];
+    var minIdx = first;
+    var maxIdx = first;
+    for (var i = first + 1; i < end; i++) {
+        if (readings[i].v < readings[minIdx].v) minIdx = i;
+        if (readings[i].v > readings[maxIdx].v) maxIdx = i;
+    }
+    var w = geo.labelW;
+    var h = geo.labelH;
+
+    var min = { dx: clamp(geo.x(readings[minIdx].v, axis), geo.left, geo.right),
+                dy: geo.y(readings[minIdx].t, viewEnd), v: readings[minIdx].v };
+    min.bx = min.dx - w - LABEL_OFFSET;
+    if (min.bx < geo.left) min.bx = min.dx + LABEL_OFFSET;
+    if (min.bx + w > geo.rightEdge) min.bx = geo.rightEdge - w;
+    min.by = min.dy - trunc(h / 2);
+
+    var max = { dx: clamp(geo.x(readings[maxIdx].v, axis), geo.left, geo.right),
+                dy: geo.y(readings[maxIdx].t, viewEnd), v: readings[maxIdx].v };
+    max.bx = max.dx + LABEL_OFFSET;
+    if (max.bx + w > geo.rightEdge) max.bx = max.dx - w - LABEL_OFFSET;
+    if (max.bx < geo.left) max.bx = geo.left;
+    max.by = max.dy - trunc(h / 2);
+
+    /* Push the boxes apart when they overlap vertically */
+    if (min.by < max.by + h && max.by < min.by + h) {
+        var overlap = Math.min(min.by + h, max.by + h) - Math.max(min.by, max.by);
+        var half = trunc((overlap + 1) / 2);
+        var upper = min.dy < max.dy ? min : max;
+        var lower = upper === min ? max : min;
+        upper.by -= half;
+        lower.by += half;
+    }
+    min.by = clamp(min.by, geo.top, geo.bottom - h);
+    max.by = clamp(max.by, geo.top, geo.bottom - h);
+    return [min, max];
+}
+
+/**
+ * Project the live chart onto the watch's layout
+ * @param {Object} layout - the watch's ChartLayout, as decoded
+ * @param {Object} chart - readings and yesterday ({v, t} in wire units,
+ *   newest first), interval (seconds), isMmol, axisAuto, viewEnd (as the
+ *   watch's chart_view_end())
+ * @returns {Object} {axis, points, yesterday, labels}, encoded for the
+ *   POINTS_AXIS, BG_POINTS, BG_YESTERDAY_POINTS and BG_LABELS keys
+ */
+function project(layout, chart) {
+    var geo = new Geometry(layout);
+    var viewEnd = chart.viewEnd;
+    var readings = chart.readings;
+    var first = lowerBound(readings, viewEnd);
+    var end = lowerBound(readings, viewEnd - Protocol.VIEW_SECONDS - 1);
+
+    var lo = Infinity;
+    var hi = -Infinity;
+    for (var i = first; i < end; i++) {
+        lo = Math.min(lo, readings[i].v);
+        hi = Math.max(hi, readings[i].v);
+    }
+    var axis = end > first ? Axis.update(chart.isMmol, chart.axisAuto, lo, hi) :
+        Axis.update(chart.isMmol, chart.axisAuto, 1, 0);
+
+    return {
+        axis: Protocol.encodeChartScales([{ min: axis.minBg, range: axis.range, step: axis.step }]),
+        points: Protocol.encodeChartPoints(projectSeries(geo, readings, 0,
+            MAX_GAP_INTERVALS * chart.interval, axis, viewEnd)),
+        yesterday: Protocol.encodeChartPoints(projectSeries(geo, chart.yesterday,
+            Protocol.YESTERDAY_SHIFT, MAX_GAP_INTERVALS * Protocol.YESTERDAY_INTERVAL, axis, viewEnd)),
+        labels: Protocol.encodeChartLabels(projectLabels(geo, readings, first, end, axis, viewEnd))
+    };
+}
+
+module.exports = { project: project };
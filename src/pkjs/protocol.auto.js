@@ -0,0 +1,194 @@
+/* Generated by tools/gen_protocol.py from protocol/schema.json - do not edit */
+
+var Protocol = {
+    VERSION: 9,
+    VIEW_SECONDS: 10800, /* Visible time window and one history page (3 hours) */
+    MIN_SAMPLE_INTERVAL: 150, /* Densest sample interval sent; one reading per 1.5 px of chart height */
+    MAX_READINGS: 72, /* Readings per transfer: one page at MIN_SAMPLE_INTERVAL */
+    MAX_EVENTS: 32, /* Treatment events per transfer */
+    YESTERDAY_SHIFT: 86400, /* Yesterday's trace: the live window this far back */
+    YESTERDAY_INTERVAL: 600, /* Yesterday's trace: one reading per this many seconds */
+    YESTERDAY_MAX: 20, /* Yesterday's trace: readings per transfer */
+    STATS_WINDOWS: 4, /* Statistics windows: 24 h, 7 d, 14 d, 30 d */
+    HEATMAP_DAYS: 7, /* Heatmap rows: local days, oldest first */
+    HEATMAP_CELLS: 168, /* Heatmap cells: HEATMAP_DAYS rows of 24 hourly means */
+    SPARK_COLUMNS: 96, /* Sparkline width: one pixel column per SPARK_COLUMN_SECONDS over 24 h */
+    SPARK_COLUMN_SECONDS: 900, /* Sparkline: time covered by one column */
+    SPARK_ROWS: 14, /* Sparkline height in pixel rows */
+    SPARK_MIN_MGDL: 40, /* Sparkline: BG on the bottom row */
+    SPARK_MAX_MGDL: 400, /* Sparkline: BG on the top row */
+    SPARK_EMPTY: 255, /* Sparkline: row value of a column with no readings */
+    REMOTE_WIDTH: 144, /* Phone-rendered chart: bitmap width in pixels */
+    REMOTE_HEIGHT: 147, /* Phone-rendered chart: bitmap height, the rows above the sparkline */
+    REMOTE_CHUNK: 1000, /* Phone-rendered chart: most CHART_RLE bytes per message */
+    POINTS_MAX: 74, /* Projected points: most per trace, VIEW_SECONDS / MIN_SAMPLE_INTERVAL plus a neighbour each side */
+    POINT_BREAK: 1, /* Projected point flag: no segment joins it to the newer point before it */
+    POINT_DOT: 2, /* Projected point flag: a visible reading, marked with a dot */
+    BG_DATA_SYNC: 0, /* BG_DATA: scheduled fetch of the live window */
+    BG_DATA_HEAD: 1, /* BG_DATA: on-demand fetch of the newest reading, outside the schedule */
+    BG_STATUS_FAILED: 1, /* BG_STATUS: the phone's fetch failed; keep what is stored */
+    BG_STATUS_EMPTY: 2, /* BG_STATUS: the phone holds no readings at all */
+    BYTES_PER_READING: 6,
+    BYTES_PER_EVENT: 6,
+    BYTES_PER_STATS_WINDOW: 12,
+    BYTES_PER_HEATMAP_CELL: 2,
+    BYTES_PER_SPARK_COLUMN: 2,
+    BYTES_PER_CHART_POINT: 3,
+    BYTES_PER_CHART_LABEL: 6,
+    BYTES_PER_CHART_SCALE: 6,
+    BYTES_PER_CHART_LAYOUT: 9,
+    BYTES_PER_ENERGY_REPORT: 28
+};
+
+/**
+ * Encode Reading objects {v, t} into a byte array for an AppMessage
+ */
+Protocol.encodeReadings = function(items) {
+    var buf = new Uint8Array(items.length * 6);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 6;
+        view.setInt16(o + 0, items[i].v, true);
+        view.setUint32(o + 2, items[i].t, true);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode Event objects {t, k, a} into a byte array for an AppMessage
+ */
+Protocol.encodeEvents = function(items) {
+    var buf = new Uint8Array(items.length * 6);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 6;
+        view.setUint32(o + 0, items[i].t, true);
+        view.setUint8(o + 4, items[i].k);
+        view.setUint8(o + 5, items[i].a);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode StatsWindow objects {n, below, above, mean, cv, gmi} into a byte array for an AppMessage
+ */
+Protocol.encodeStatsWindows = function(items) {
+    var buf = new Uint8Array(items.length * 12);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 12;
+        view.setUint16(o + 0, items[i].n, true);
+        view.setUint16(o + 2, items[i].below, true);
+        view.setUint16(o + 4, items[i].above, true);
+        view.setInt16(o + 6, items[i].mean, true);
+        view.setUint16(o + 8, items[i].cv, true);
+        view.setUint16(o + 10, items[i].gmi, true);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode HeatmapCell objects {v} into a byte array for an AppMessage
+ */
+Protocol.encodeHeatmapCells = function(items) {
+    var buf = new Uint8Array(items.length * 2);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 2;
+        view.setInt16(o + 0, items[i].v, true);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode SparkColumn objects {lo, hi} into a byte array for an AppMessage
+ */
+Protocol.encodeSparkColumns = function(items) {
+    var buf = new Uint8Array(items.length * 2);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 2;
+        view.setUint8(o + 0, items[i].lo);
+        view.setUint8(o + 1, items[i].hi);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode ChartPoint objects {x, y, f} into a byte array for an AppMessage
+ */
+Protocol.encodeChartPoints = function(items) {
+    var buf = new Uint8Array(items.length * 3);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 3;
+        view.setUint8(o + 0, items[i].x);
+        view.setUint8(o + 1, items[i].y);
+        view.setUint8(o + 2, items[i].f);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode ChartLabel objects {dx, dy, bx, by, v} into a byte array for an AppMessage
+ */
+Protocol.encodeChartLabels = function(items) {
+    var buf = new Uint8Array(items.length * 6);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 6;
+        view.setUint8(o + 0, items[i].dx);
+        view.setUint8(o + 1, items[i].dy);
+        view.setUint8(o + 2, items[i].bx);
+        view.setUint8(o + 3, items[i].by);
+        view.setInt16(o + 4, items[i].v, true);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Encode ChartScale objects {min, range, step} into a byte array for an AppMessage
+ */
+Protocol.encodeChartScales = function(items) {
+    var buf = new Uint8Array(items.length * 6);
+    var view = new DataView(buf.buffer);
+    for (var i = 0; i < items.length; i++) {
+        var o = i * 6;
+        view.setInt16(o + 0, items[i].min, true);
+        view.setInt16(o + 2, items[i].range, true);
+        view.setInt16(o + 4, items[i].step, true);
+    }
+    return Array.prototype.slice.call(buf);
+};
+
+/**
+ * Decode a packed ChartLayout byte array; null if it is too short
+ */
+Protocol.decodeChartLayout = function(bytes) {
+    if (!bytes || bytes.length < 9) return null;
+    var view = new DataView(new Uint8Array(bytes).buffer);
+    return {
+        chart_x: view.getUint8(0),
+        chart_y: view.getUint8(1),
+        chart_w: view.getUint8(2),
+        chart_h: view.getUint8(3),
+        padding: view.getUint8(4),
+        seconds_per_pixel: view.getUint16(5, true),
+        label_w: view.getUint8(7),
+        label_h: view.getUint8(8)
+    };
+};
+
+/**
+ * Decode a packed EnergyReport byte array; null if it is too short
+ */
+Protocol.decodeEnergyReport = function(bytes) {
+    if (!bytes || bytes.length < 28) return null;
+    var view = new DataView(new Uint8Array(bytes).buffer);
+    return {
+        elapsed: view.getUint32(0, true),
+        counters: [view.getUint32(4, true), view.getUint32(8, true), view.getUint32(12, true), view.getUint32(16, true), view.getUint32(20, true), view.getUint32(24, true)]
+    };
+};
+
+module.exports = Protocol;
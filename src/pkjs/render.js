@@ -0,0 +1,400 @@
+// Phone-side chart renderer for the phone-rendered chart mode
+// ES5 compatible version
+//
+// Draws the chart exactly as the watch's chart_layer_update_proc would
+// (grid, labels, yesterday's trace, today's trace, treatments, extremum
+// labels) into a 1-bit bitmap and run-length encodes it for the watch,
+// which only decodes and blits. Layout constants mirror src/c/main.c.
+
+var Axis = require('./axis');
+var Protocol = require('./protocol.auto');
+
+var WIDTH = Protocol.REMOTE_WIDTH;
+var HEIGHT = Protocol.REMOTE_HEIGHT;
+
+var CHART_START_X = 30;
+var CHART_START_Y = 10;
+var CHART_WIDTH = 114;
+var CHART_HEIGHT = 122;
+var TIME_SPACING = 3;
+var TIME_SCALE_SECONDS = 300;
+var SECONDS_PER_PIXEL = TIME_SCALE_SECONDS / TIME_SPACING;
+var GRID_PADDING = 2;
+var DOT_ON = 2;
+var DOT_PERIOD = 5;
+var TIME_GRID_MINUTES = 30;
+var MAX_GAP_INTERVALS = 2;
+var PLOT_TOP = CHART_START_Y + GRID_PADDING;
+var PLOT_BOTTOM = CHART_START_Y + CHART_HEIGHT - GRID_PADDING;
+var PLOT_LEFT = CHART_START_X + GRID_PADDING;
+var PLOT_RIGHT = CHART_START_X + CHART_WIDTH - GRID_PADDING;
+
+/* Glyphs for labels: 7 rows each, most significant bit leftmost. The
+   watch's Gothic 14 digits are about this size. */
+var FONT_HEIGHT = 7;
+var FONT = {
+    '0': [5, [14, 17, 19, 21, 25, 17, 14]],
+    '1': [5, [4, 12, 4, 4, 4, 4, 14]],
+    '2': [5, [14, 17, 1, 2, 4, 8, 31]],
+    '3': [5, [31, 2, 4, 2, 1, 17, 14]],
+    '4': [5, [2, 6, 10, 18, 31, 2, 2]],
+    '5': [5, [31, 16, 30, 1, 1, 17, 14]],
+    '6': [5, [6, 8, 16, 30, 17, 17, 14]],
+    '7': [5, [31, 1, 2, 4, 8, 8, 8]],
+    '8': [5, [14, 17, 17, 14, 17, 17, 14]],
+    '9': [5, [14, 17, 17, 15, 1, 2, 12]],
+    '.': [1, [0, 0, 0, 0, 0, 0, 1]],
+    'h': [5, [16, 16, 22, 25, 17, 17, 17]],
+    'm': [5, [0, 0, 26, 21, 21, 17, 17]],
+    'u': [5, [0, 0, 17, 17, 17, 19, 13]],
+    'g': [5, [0, 15, 17, 17, 15, 1, 14]]
+};
+
+var trunc = Axis.trunc;
+
+/** Grid lines of a scale, as axis.c's build() lays them out */
+function axisLines(scale, isMmol) {
+    var lines = [];
+    function add(value, solid, labelled) {
+        if (value < scale.minBg || value > scale.minBg + scale.range) return;
+        for (var i = 0; i < lines.length; i++) {
+            if (lines[i].value === value) {
+                lines[i].solid = lines[i].solid || solid;
+                return;
+            }
+        }
+        if (lines.length === 8) return;
+        var label = value === 0 ? '0' : isMmol ?
+            trunc(value / 10) + '.' + value % 10 : String(value);
+        lines.push({
+            value: value,
+            x: PLOT_LEFT + trunc((value - scale.minBg) * (CHART_WIDTH - 2 * GRID_PADDING) / scale.range),
+            solid: solid,
+            labelled: labelled,
+            label: label
+        });
+    }
+    if (scale.step === 0) {
+        var grid = isMmol ? [0, 40, 100, 150, 200] : [0, 72, 180, 270, 360];
+        grid.forEach(function(v) { add(v, false, true); });
+    } else {
+        for (var v = scale.minBg; v <= scale.minBg + scale.range; v += scale.step) {
+            add(v, false, true);
+        }
+    }
+    add(isMmol ? 40 : 72, true, scale.step === 0);
+    add(isMmol ? 100 : 180, true, scale.step === 0);
+    return lines;
+}
+
+/* --- 1-bit canvas: one byte per pixel, 1 = black --- */
+
+function Canvas() {
+    this.pixels = new Uint8Array(WIDTH * HEIGHT);
+}
+
+Canvas.prototype.set = function(x, y, black) {
+    if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+    this.pixels[y * WIDTH + x] = black ? 1 : 0;
+};
+
+Canvas.prototype.fillRect = function(x, y, w, h, black) {
+    for (var j = y; j < y + h; j++) {
+        for (var i = x; i < x + w; i++) {
+            this.set(i, j, black);
+        }
+    }
+};
+
+Canvas.prototype.fillCircle = function(cx, cy, r, black) {
+    for (var dy = -r; dy <= r; dy++) {
+        for (var dx = -r; dx <= r; dx++) {
+            if (dx * dx + dy * dy <= r * r + r) this.set(cx + dx, cy + dy, black);
+        }
+    }
+};
+
+/** Line from a to b; width 2 uses a 2x2 pen, like a 2 px stroke */
+Canvas.prototype.line = function(ax, ay, bx, by, width) {
+    var dx = Math.abs(bx - ax);
+    var dy = -Math.abs(by - ay);
+    var sx = ax < bx ? 1 : -1;
+    var sy = ay < by ? 1 : -1;
+    var err = dx + dy;
+    for (;;) {
+        this.set(ax, ay, true);
+        if (width > 1) {
+            this.set(ax + 1, ay, true);
+            this.set(ax, ay + 1, true);
+            this.set(ax + 1, ay + 1, true);
+        }
+        if (ax === bx && ay === by) break;
+        var e2 = 2 * err;
+        if (e2 >= dy) { err += dy; ax += sx; }
+        if (e2 <= dx) { err += dx; ay += sy; }
+    }
+};
+
+/** Dotted line continuing the pattern at phase, as draw_dotted_line() */
+Canvas.prototype.dottedLine = function(ax, ay, bx, by, phase) {
+    var dx = bx - ax;
+    var dy = by - ay;
+    var steps = Math.max(Math.abs(dx), Math.abs(dy));
+    for (var i = 0; i < steps; i++, phase++) {
+        if (phase % DOT_PERIOD < DOT_ON) {
+            this.set(ax + trunc(dx * i / steps), ay + trunc(dy * i / steps), true);
+        }
+    }
+    return phase;
+};
+
+/** Text in a box: align is 'left', 'center' or 'right' */
+Canvas.prototype.text = function(str, x, y, w, h, align) {
+    var width = -1;
+    for (var i = 0; i < str.length; i++) {
+        if (FONT[str[i]]) width += FONT[str[i]][0] + 1;
+    }
+    var left = align === 'right' ? x + w - width :
+        align === 'center' ? x + trunc((w - width) / 2) : x;
+    var top = y + trunc((h - FONT_HEIGHT) / 2) + 1;
+    for (var c = 0; c < str.length; c++) {
+        var glyph = FONT[str[c]];
+        if (!glyph) continue;
+        for (var row = 0; row < FONT_HEIGHT; row++) {
+            for (var col = 0; col < glyph[0]; col++) {
+                if (glyph[1][row] & (1 << (glyph[0] - 1 - col))) this.set(left + col, top + row, true);
+            }
+        }
+        left += glyph[0] + 1;
+    }
+};
+
+/* --- Chart, as draw_chart() --- */
+
+function timestampToY(ts, viewEnd) {
+    return PLOT_BOTTOM - trunc((viewEnd - ts) * TIME_SPACING / TIME_SCALE_SECONDS);
+}
+
+function bgToX(v, axis) {
+    return PLOT_LEFT + trunc((v - axis.minBg) * (CHART_WIDTH - 2 * GRID_PADDING) / axis.range);
+}
+
+function clamp(v, lo, hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+function formatValue(v, isMmol) {
+    return isMmol ? trunc(v / 10) + '.' + v % 10 : String(v);
+}
+
+/** Index of the first reading with t <= ts (readings newest first) */
+function lowerBound(readings, ts) {
+    var lo = 0;
+    var hi = readings.length;
+    while (lo < hi) {
+        var mid = (lo + hi) >> 1;
+        if (readings[mid].t > ts) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+function drawGrid(canvas, lines, viewEnd, viewOffset) {
+    lines.forEach(function(line) {
+        if (line.x < PLOT_LEFT || line.x > PLOT_RIGHT) return;
+        for (var y = PLOT_TOP; y <= PLOT_BOTTOM; y++) {
+            if (line.solid || (y - PLOT_TOP) % DOT_PERIOD < DOT_ON) canvas.set(line.x, y, true);
+        }
+        if (line.labelled) {
+            canvas.text(line.label, line.x - 15, CHART_START_Y + CHART_HEIGHT, 30, 14, 'center');
+        }
+    });
+    canvas.line(PLOT_LEFT, PLOT_BOTTOM, PLOT_RIGHT, PLOT_BOTTOM, 1);
+
+    for (var minutes = 0; minutes <= Protocol.VIEW_SECONDS / 60; minutes += TIME_GRID_MINUTES) {
+        var y = timestampToY(viewEnd - minutes * 60, viewEnd);
+        if (y < CHART_START_Y || y > CHART_START_Y + CHART_HEIGHT) continue;
+        for (var x = PLOT_LEFT; x <= PLOT_RIGHT; x++) {
+            if ((x - PLOT_LEFT) % DOT_PERIOD < DOT_ON) canvas.set(x, y, true);
+        }
+        if (minutes === 0) continue;
+        var ago = trunc(viewOffset / 60) + minutes;
+        var label = ago === 30 ? '30m' : ago % 60 === 0 ? ago / 60 + 'h' : trunc(ago / 60) + '.5h';
+        canvas.text(label, 0, y - 7, 28, 14, 'right');
+    }
+    canvas.line(PLOT_LEFT, PLOT_TOP, PLOT_LEFT, PLOT_BOTTOM, 1);
+}
+
+function drawSeries(canvas, series, axis, viewEnd) {
+    var first = lowerBound(series.readings, viewEnd - series.shift);
+    var end = lowerBound(series.readings, viewEnd - series.shift - Protocol.VIEW_SECONDS - 1);
+    if (series.readings.length === 0) return;
+    var lo = first > 0 ? first - 1 : first;
+    var hi = end < series.readings.length ? end : end - 1;
+    var phase = 0;
+    var prev = null;
+    for (var i = lo; i <= hi; i++) {
+        var r = series.readings[i];
+        var ts = r.t + series.shift;
+        var p = { x: clamp(bgToX(r.v, axis), PLOT_LEFT, PLOT_RIGHT), y: clamp(timestampToY(ts, viewEnd), PLOT_TOP, PLOT_BOTTOM), t: ts };
+        if (prev) {
+            if (prev.t - ts <= series.maxGap) {
+                if (series.faint) {
+                    phase = canvas.dottedLine(prev.x, prev.y, p.x, p.y, phase);
+                } else {
+                    canvas.line(prev.x, prev.y, p.x, p.y, 2);
+                }
+            }
+            if (!series.faint && i - 1 >= first && i - 1 < end) canvas.fillCircle(prev.x, prev.y, 1, true);
+        }
+        prev = p;
+    }
+    if (prev && !series.faint && hi >= first && hi < end) canvas.fillCircle(prev.x, prev.y, 1, true);
+}
+
+function drawEvents(canvas, events, viewEnd) {
+    var x = PLOT_RIGHT - 4;
+    events.forEach(function(e) {
+        var y = timestampToY(e.t, viewEnd);
+        if (y < PLOT_TOP || y > PLOT_BOTTOM) return;
+        var label;
+        if (e.k === 1) {
+            canvas.fillRect(x - 3, y - 3, 7, 7, true);
+            label = trunc(e.a / 10) + '.' + e.a % 10 + 'u';
+        } else {
+            canvas.fillCircle(x, y, 4, true);
+            canvas.fillCircle(x, y, 2, false);
+            label = e.a + 'g';
+        }
+        canvas.text(label, x - 36, y - 9, 30, 16, 'right');
+    });
+}
+
+function drawExtrema(canvas, readings, first, end, axis, viewEnd, isMmol) {
+    if (end - first < 1) return;
+    var minIdx = first;
+    var maxIdx = first;
+    for (var i = first + 1; i < end; i++) {
+        if (readings[i].v < readings[minIdx].v) minIdx = i;
+        if (readings[i].v > readings[maxIdx].v) maxIdx = i;
+    }
+    var w = 30;
+    var h = 16;
+    var offset = 4;
+    var rightEdge = CHART_START_X + CHART_WIDTH;
+
+    var minPx = clamp(bgToX(readings[minIdx].v, axis), PLOT_LEFT, PLOT_RIGHT);
+    var minPy = timestampToY(readings[minIdx].t, viewEnd);
+    var minLx = minPx - w - offset;
+    if (minLx < PLOT_LEFT) minLx = minPx + offset;
+    if (minLx + w > rightEdge) minLx = rightEdge - w;
+    var minLy = minPy - h / 2;
+
+    var maxPx = clamp(bgToX(readings[maxIdx].v, axis), PLOT_LEFT, PLOT_RIGHT);
+    var maxPy = timestampToY(readings[maxIdx].t, viewEnd);
+    var maxLx = maxPx + offset;
+    if (maxLx + w > rightEdge) maxLx = maxPx - w - offset;
+    if (maxLx < PLOT_LEFT) maxLx = PLOT_LEFT;
+    var maxLy = maxPy - h / 2;
+
+    if (minLy < maxLy + h && maxLy < minLy + h) {
+        var overlap = Math.min(minLy + h, maxLy + h) - Math.max(minLy, maxLy);
+        var half = trunc((overlap + 1) / 2);
+        if (minPy < maxPy) {
+            minLy -= half;
+            maxLy += half;
+        } else {
+            maxLy -= half;
+            minLy += half;
+        }
+    }
+    var top = PLOT_TOP;
+    var bottom = PLOT_BOTTOM - h;
+    minLy = clamp(minLy, top, bottom);
+    maxLy = clamp(maxLy, top, bottom);
+
+    [[minPx, minPy], [maxPx, maxPy]].forEach(function(p) {
+        canvas.fillCircle(p[0], p[1], 4, true);
+        canvas.fillCircle(p[0], p[1], 1, false);
+    });
+    canvas.fillRect(minLx, minLy, w, h, false);
+    canvas.text(formatValue(readings[minIdx].v, isMmol), minLx, minLy, w, h, 'center');
+    canvas.fillRect(maxLx, maxLy, w, h, false);
+    canvas.text(formatValue(readings[maxIdx].v, isMmol), maxLx, maxLy, w, h, 'center');
+}
+
+/**
+ * Render the live chart
+ * @param {Object} chart - readings and yesterday ({v, t} in wire units,
+ *   newest first), events ({t, k, a}), interval (seconds), isMmol,
+ *   axisAuto, viewEnd (rounded as the watch's chart_view_end())
+ * @returns {Canvas}
+ */
+function render(chart) {
+    var canvas = new Canvas();
+    var viewEnd = chart.viewEnd;
+    var readings = chart.readings;
+    var first = lowerBound(readings, viewEnd);
+    var end = lowerBound(readings, viewEnd - Protocol.VIEW_SECONDS - 1);
+
+    var lo = Infinity;
+    var hi = -Infinity;
+    for (var i = first; i < end; i++) {
+        lo = Math.min(lo, readings[i].v);
+        hi = Math.max(hi, readings[i].v);
+    }
+    var axis = end > first ? Axis.update(chart.isMmol, chart.axisAuto, lo, hi) :
+        Axis.update(chart.isMmol, chart.axisAuto, 1, 0);
+
+    drawGrid(canvas, axisLines(axis, chart.isMmol), viewEnd, 0);
+    drawSeries(canvas, {
+        readings: chart.yesterday, shift: Protocol.YESTERDAY_SHIFT,
+        maxGap: MAX_GAP_INTERVALS * Protocol.YESTERDAY_INTERVAL, faint: true
+    }, axis, viewEnd);
+    drawSeries(canvas, {
+        readings: readings, shift: 0, maxGap: MAX_GAP_INTERVALS * chart.interval, faint: false
+    }, axis, viewEnd);
+    drawEvents(canvas, chart.events, viewEnd);
+    drawExtrema(canvas, readings, first, end, axis, viewEnd, chart.isMmol);
+    return canvas;
+}
+
+/** The watch's chart_view_end() for the live view at now */
+function viewEndAt(now) {
+    return Math.ceil(now / SECONDS_PER_PIXEL) * SECONDS_PER_PIXEL;
+}
+
+/**
+ * Encode a canvas for CHART_RLE: each pixel XORed with the one above it
+ * (above the first row: white), so vertical lines vanish, then run
+ * lengths of alternating unchanged/changed pixels in row-major order,
+ * starting with unchanged. Runs longer than 255 continue after a 0.
+ * @returns {Array} Byte values
+ */
+function encode(canvas) {
+    var out = [];
+    var pixels = canvas.pixels;
+    var changed = 0;
+    var run = 0;
+    for (var i = 0; i < pixels.length; i++) {
+        var above = i >= WIDTH ? pixels[i - WIDTH] : 0;
+        var bit = pixels[i] ^ above;
+        if (bit !== changed) {
+            out.push(run);
+            run = 0;
+            changed = bit;
+        }
+        if (run === 255) {
+            out.push(255, 0);
+            run = 0;
+        }
+        run++;
+    }
+    out.push(run);
+    return out;
+}
+
+module.exports = {
+    render: render,
+    encode: encode,
+    viewEndAt: viewEndAt
+};
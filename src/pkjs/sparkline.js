@@ -0,0 +1,59 @@
+// 24-hour sparkline for the strip under the watch's chart
+// ES5 compatible version
+
+var Protocol = require('./protocol.auto');
+
+var COLUMNS = Protocol.SPARK_COLUMNS;
+var COLUMN_SECONDS = Protocol.SPARK_COLUMN_SECONDS;
+
+/**
+ * Pixel row of a BG value (mg/dL): 0 at SPARK_MIN_MGDL, the top row at
+ * SPARK_MAX_MGDL, clamped to the strip
+ */
+function row(mgdl) {
+    var top = Protocol.SPARK_ROWS - 1;
+    var r = Math.round((mgdl - Protocol.SPARK_MIN_MGDL) * top /
+        (Protocol.SPARK_MAX_MGDL - Protocol.SPARK_MIN_MGDL));
+    return Math.max(0, Math.min(top, r));
+}
+
+/**
+ * Time at the sparkline's right edge: now, rounded up to a whole column so
+ * columns cover the same quarter hours from one refresh to the next
+ */
+function end(now) {
+    return Math.ceil(now / COLUMN_SECONDS) * COLUMN_SECONDS;
+}
+
+/**
+ * Lowest and highest row reached in each column over the 24 hours up to
+ * endTime, oldest column first. The watch draws each as a vertical span,
+ * so all projection happens here. Columns without readings read
+ * SPARK_EMPTY.
+ * @param {Array} cache - Cached readings {v: mg/dL, t}, newest first
+ * @param {number} endTime - Right edge, from end()
+ */
+function build(cache, endTime) {
+    var columns = [];
+    for (var c = 0; c < COLUMNS; c++) {
+        columns.push({ lo: Protocol.SPARK_EMPTY, hi: Protocol.SPARK_EMPTY });
+    }
+    for (var i = 0; i < cache.length; i++) {
+        var age = endTime - cache[i].t;
+        if (age < 0) continue;
+        var index = COLUMNS - 1 - Math.floor(age / COLUMN_SECONDS);
+        if (index < 0) break;  /* Newest first: the rest are older still */
+        var r = row(cache[i].v);
+        var column = columns[index];
+        if (column.lo === Protocol.SPARK_EMPTY) {
+            column.lo = r;
+            column.hi = r;
+        } else {
+            column.lo = Math.min(column.lo, r);
+            column.hi = Math.max(column.hi, r);
+        }
+    }
+    return columns;
+}
+
+module.exports = { build: build, end: end };
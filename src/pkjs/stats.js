@@ -0,0 +1,151 @@
+// Rolling glucose statistics
+// ES5 compatible version
+
+var HOUR = 3600;
+/* Window lengths in hours: 24 h, 7 d, 14 d, 30 d (the watch's stats page
+   shows them in this order) */
+var WINDOW_HOURS = [24, 7 * 24, 14 * 24, 30 * 24];
+var OLDEST = WINDOW_HOURS.length - 1;
+/* Consensus time-in-range target, mg/dL */
+var LOW_MGDL = 70;
+var HIGH_MGDL = 180;
+
+/* Aggregate slots: readings, below range, above range, sum, sum of squares.
+   Values are integer mg/dL, so the sums stay exact under subtraction. */
+var N = 0, BELOW = 1, ABOVE = 2, SUM = 3, SQUARES = 4;
+
+function emptyAggregate() {
+    return [0, 0, 0, 0, 0];
+}
+
+function accumulate(target, source, sign) {
+    for (var i = 0; i < target.length; i++) {
+        target[i] += sign * source[i];
+    }
+}
+
+/**
+ * Stats constructor. Readings are summed into hourly buckets covering the
+ * longest window; each window keeps a running total and the first hour it
+ * includes. Adding a reading updates its bucket and every window that
+ * covers it; advancing the clock subtracts only the buckets that leave a
+ * window, so no refresh rescans the readings.
+ * @param {Object} state - Saved state from toJSON() (optional)
+ */
+function Stats(state) {
+    this.buckets = {};
+    this.totals = [];
+    this.starts = [];
+    for (var w = 0; w < WINDOW_HOURS.length; w++) {
+        this.totals.push(emptyAggregate());
+        this.starts.push(0);
+    }
+    if (state && state.buckets && state.totals && state.starts &&
+        state.totals.length === WINDOW_HOURS.length) {
+        this.buckets = state.buckets;
+        this.totals = state.totals;
+        this.starts = state.starts;
+    }
+}
+
+/**
+ * Add one reading {v (mg/dL), t}. The caller adds each reading once;
+ * readings older than the longest window are ignored.
+ */
+Stats.prototype.add = function(reading) {
+    var hour = Math.floor(reading.t / HOUR);
+    if (hour < this.starts[OLDEST] || !(reading.v > 0)) return;
+
+    var v = Math.round(reading.v);
+    var sample = [1, v < LOW_MGDL ? 1 : 0, v > HIGH_MGDL ? 1 : 0, v, v * v];
+    var bucket = this.buckets[hour];
+    if (!bucket) {
+        bucket = this.buckets[hour] = emptyAggregate();
+    }
+    accumulate(bucket, sample, 1);
+    for (var w = 0; w < WINDOW_HOURS.length; w++) {
+        if (hour >= this.starts[w]) accumulate(this.totals[w], sample, 1);
+    }
+};
+
+/**
+ * Slide every window to end at the hour containing now (seconds),
+ * subtracting the buckets that fall out and dropping those no window
+ * covers any more.
+ */
+Stats.prototype.advance = function(now) {
+    var hour = Math.floor(now / HOUR);
+    var w, h;
+    for (w = 0; w < WINDOW_HOURS.length; w++) {
+        var start = hour - WINDOW_HOURS[w] + 1;
+        if (start <= this.starts[w]) continue;
+        if (start - this.starts[w] > WINDOW_HOURS[OLDEST]) {
+            /* Long absence: cheaper to visit the buckets than the hours */
+            for (h in this.buckets) {
+                if (this.buckets.hasOwnProperty(h) && h >= this.starts[w] && h < start) {
+                    accumulate(this.totals[w], this.buckets[h], -1);
+                }
+            }
+        } else {
+            for (h = this.starts[w]; h < start; h++) {
+                if (this.buckets[h]) accumulate(this.totals[w], this.buckets[h], -1);
+            }
+        }
+        this.starts[w] = start;
+    }
+    for (h in this.buckets) {
+        if (this.buckets.hasOwnProperty(h) && h < this.starts[OLDEST]) {
+            delete this.buckets[h];
+        }
+    }
+};
+
+/**
+ * Summaries for the watch, one per window in WINDOW_HOURS order:
+ * {n, below, above} (below/above in 0.1 %), mean (x10, via toUnits),
+ * cv (0.1 %) and gmi (0.1 %). Windows without readings are all zero.
+ * @param {Function} toUnits - Convert a mg/dL value to the wire's x10 units
+ */
+Stats.prototype.summary = function(toUnits) {
+    var out = [];
+    for (var w = 0; w < WINDOW_HOURS.length; w++) {
+        var a = this.totals[w];
+        var n = a[N];
+        if (n === 0) {
+            out.push({ n: 0, below: 0, above: 0, mean: 0, cv: 0, gmi: 0 });
+            continue;
+        }
+        var mean = a[SUM] / n;
+        var sd = Math.sqrt(Math.max(a[SQUARES] / n - mean * mean, 0));
+        out.push({
+            n: Math.min(n, 65535),
+            below: Math.round(1000 * a[BELOW] / n),
+            above: Math.round(1000 * a[ABOVE] / n),
+            mean: toUnits(mean),
+            cv: Math.round(1000 * sd / mean),
+            /* Glucose management indicator (Bergenstal 2018), % */
+            gmi: Math.round(10 * (3.31 + 0.02392 * mean))
+        });
+    }
+    return out;
+};
+
+/**
+ * Mean (mg/dL, 0 if none) of each of count hours from startHour (hours
+ * since the epoch), straight from the hourly buckets. Hours older than the
+ * longest window read as 0.
+ */
+Stats.prototype.hourlyMeans = function(startHour, count) {
+    var out = [];
+    for (var h = startHour; h < startHour + count; h++) {
+        var bucket = this.buckets[h];
+        out.push(bucket && bucket[N] > 0 ? bucket[SUM] / bucket[N] : 0);
+    }
+    return out;
+};
+
+Stats.prototype.toJSON = function() {
+    return { buckets: this.buckets, totals: this.totals, starts: this.starts };
+};
+
+module.exports = Stats;
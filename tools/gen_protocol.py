@@ -0,0 +1,272 @@
+#!/usr/bin/env python
+"""
+Generate the AppMessage codecs from protocol/schema.json.
+
+Outputs (checked in, regenerated by `pebble build` through wscript):
+  src/c/protocol.auto.h      constants, fixed-offset decoders for
+                             phone->watch layouts, encoders for
+                             watch->phone layouts
+  src/pkjs/protocol.auto.js  the same constants, typed-array encoders
+                             for phone->watch layouts, decoders for
+                             watch->phone layouts
+  package.json               "messageKeys", in schema order
+
+Usage: gen_protocol.py [--check]   (--check: exit 1 if anything is stale)
+"""
+from __future__ import print_function
+
+import io
+import json
+import os
+import re
+import sys
+from collections import OrderedDict
+
+SCHEMA = os.path.join('protocol', 'schema.json')
+C_OUT = os.path.join('src', 'c', 'protocol.auto.h')
+JS_OUT = os.path.join('src', 'pkjs', 'protocol.auto.js')
+PACKAGE = 'package.json'
+
+BANNER = 'Generated by tools/gen_protocol.py from protocol/schema.json - do not edit'
+
+TYPES = {
+    # name: (bytes, signed, C type, DataView suffix)
+    'int8':   (1, True,  'int8_t',   'Int8'),
+    'uint8':  (1, False, 'uint8_t',  'Uint8'),
+    'int16':  (2, True,  'int16_t',  'Int16'),
+    'uint16': (2, False, 'uint16_t', 'Uint16'),
+    'int32':  (4, True,  'int32_t',  'Int32'),
+    'uint32': (4, False, 'uint32_t', 'Uint32'),
+}
+KEY_TYPES = set(TYPES) | set(['cstring', 'bytes'])
+
+
+def snake(name):
+    return re.sub(r'(?<!^)(?=[A-Z])', '_', name).lower()
+
+
+def load_schema(root):
+    with io.open(os.path.join(root, SCHEMA), encoding='utf-8') as f:
+        schema = json.load(f, object_pairs_hook=OrderedDict)
+
+    keys = OrderedDict((k['name'], k) for k in schema['keys'])
+    for k in schema['keys']:
+        if k['type'] not in KEY_TYPES:
+            raise ValueError('key %s: unknown type %s' % (k['name'], k['type']))
+        # Bytes keys name their layout, unless they carry an opaque stream
+        if k['type'] == 'bytes' and 'layout' in k and k['layout'] not in schema['layouts']:
+            raise ValueError('key %s: unknown layout %s' % (k['name'], k.get('layout')))
+    for m in schema['messages']:
+        for name in m['keys'] + m.get('optional', []):
+            if name not in keys:
+                raise ValueError('message %s: unknown key %s' % (m['name'], name))
+
+    for name, layout in schema['layouts'].items():
+        offset = 0
+        for field in layout['fields']:
+            if field['type'] not in TYPES:
+                raise ValueError('layout %s: unknown type %s' % (name, field['type']))
+            field['offset'] = offset
+            offset += TYPES[field['type']][0] * field.get('count', 1)
+        layout['size'] = offset
+    return schema
+
+
+# --- C ----------------------------------------------------------------------
+
+def c_read(field, offset):
+    size, signed, ctype = TYPES[field['type']][:3]
+    parts = []
+    for b in range(size):
+        byte = 'p[%d]' % (offset + b)
+        if size > 1:
+            byte = '(uint%d_t)%s' % (size * 8, byte)
+        parts.append(byte if b == 0 else '(%s << %d)' % (byte, 8 * b))
+    cast = field.get('c_cast', ctype)
+    # Continuation lines line up under the first byte
+    indent = len('    out->%s = (%s)(' % (field['name'], cast))
+    expr = (' |\n' + ' ' * indent).join(parts) if size == 4 else ' | '.join(parts)
+    return '(%s)(%s)' % (cast, expr)
+
+
+def c_write(field, offset, value):
+    size = TYPES[field['type']][0]
+    lines = []
+    for b in range(size):
+        shifted = value if b == 0 else '(%s >> %d)' % (value, 8 * b)
+        lines.append('    p[%d] = (uint8_t)(%s & 0xFF);' % (offset + b, shifted))
+    return lines
+
+
+def gen_c(schema):
+    out = ['/* %s */' % BANNER, '#pragma once', '', '#include <pebble.h>']
+    includes = [l['c_include'] for l in schema['layouts'].values() if 'c_include' in l]
+    for inc in sorted(set(includes)):
+        out.append('#include "%s"' % inc)
+    out += ['', '#define PROTOCOL_VERSION  %d' % schema['version'], '']
+
+    for name, const in schema['constants'].items():
+        out.append('/* %s */' % const['doc'])
+        out.append('#define %s  %d' % (name, const['value']))
+    out.append('')
+
+    out.append('/* Messages (keys in package.json "messageKeys")')
+    for m in schema['messages']:
+        arrow = 'watch -> phone' if m['direction'] == 'watch_to_phone' else 'phone -> watch'
+        keys = ', '.join(m['keys'])
+        if m.get('optional'):
+            keys += ' [, %s]' % ', '.join(m['optional'])
+        out.append(' *   %s (%s): %s' % (m['name'], arrow, keys))
+    out += [' */', '']
+
+    for name, layout in schema['layouts'].items():
+        size_name = 'BYTES_PER_%s' % snake(name).upper()
+        fn = snake(name)
+        ctype = layout['c_type']
+        out.append('/* ---------------------------------------------------------------------------')
+        out.append(' * %s: %d bytes, little-endian' % (name, layout['size']))
+        out.append(' * --------------------------------------------------------------------------- */')
+        out.append('#define %s  %d' % (size_name, layout['size']))
+        out.append('')
+
+        if 'c_include' not in layout:
+            out.append('typedef struct {')
+            for f in layout['fields']:
+                count = '[%d]' % f['count'] if 'count' in f else ''
+                out.append('    %s %s%s;%s' % (TYPES[f['type']][2], f['name'], count,
+                                               '  /* %s */' % f['doc'] if 'doc' in f else ''))
+            out.append('} %s;' % ctype)
+            out.append('')
+
+        if layout['direction'] == 'phone_to_watch':
+            out.append('/** Decode one %s at p. */' % name)
+            out.append('static inline void proto_decode_%s(const uint8_t *p, %s *out) {' % (fn, ctype))
+            for f in layout['fields']:
+                out.append('    out->%s = %s;' % (f['name'], c_read(f, f['offset'])))
+            out.append('}')
+            out.append('')
+            out.append('/** Decode up to max packed %ss from length bytes; returns the count. */' % name)
+            head = 'static inline int proto_decode_%ss(' % fn
+            out.append(head + 'const uint8_t *data, int length,')
+            out.append(' ' * len(head) + '%s *out, int max) {' % ctype)
+            out.append('    int n = length / %s;' % size_name)
+            out.append('    if (n > max) n = max;')
+            out.append('    for (int i = 0; i < n; i++) {')
+            out.append('        proto_decode_%s(data + i * %s, &out[i]);' % (fn, size_name))
+            out.append('    }')
+            out.append('    return n;')
+            out.append('}')
+        else:
+            out.append('/** Encode in into p (%s bytes). */' % size_name)
+            out.append('static inline void proto_encode_%s(const %s *in, uint8_t *p) {' % (fn, ctype))
+            for f in layout['fields']:
+                width = TYPES[f['type']][0]
+                if 'count' in f:
+                    for i in range(f['count']):
+                        out += c_write(f, f['offset'] + i * width, 'in->%s[%d]' % (f['name'], i))
+                else:
+                    out += c_write(f, f['offset'], 'in->%s' % f['name'])
+            out.append('}')
+        out.append('')
+    return '\n'.join(out)
+
+
+# --- JS ---------------------------------------------------------------------
+
+def gen_js(schema):
+    out = ['/* %s */' % BANNER, '', 'var Protocol = {', '    VERSION: %d,' % schema['version']]
+    for name, const in schema['constants'].items():
+        out.append('    %s: %d, /* %s */' % (name, const['value'], const['doc']))
+    sizes = ['    BYTES_PER_%s: %d' % (snake(n).upper(), l['size']) for n, l in schema['layouts'].items()]
+    out.append(',\n'.join(sizes))
+    out += ['};', '']
+
+    for name, layout in schema['layouts'].items():
+        size = layout['size']
+        if layout['direction'] == 'phone_to_watch':
+            props = ', '.join(f['js'] for f in layout['fields'])
+            out.append('/**')
+            out.append(' * Encode %s objects {%s} into a byte array for an AppMessage' % (name, props))
+            out.append(' */')
+            out.append('Protocol.encode%ss = function(items) {' % name)
+            out.append('    var buf = new Uint8Array(items.length * %d);' % size)
+            out.append('    var view = new DataView(buf.buffer);')
+            out.append('    for (var i = 0; i < items.length; i++) {')
+            out.append('        var o = i * %d;' % size)
+            for f in layout['fields']:
+                width = TYPES[f['type']][0]
+                suffix = TYPES[f['type']][3]
+                endian = ', true' if width > 1 else ''
+                out.append('        view.set%s(o + %d, items[i].%s%s);' % (suffix, f['offset'], f['js'], endian))
+            out.append('    }')
+            out.append('    return Array.prototype.slice.call(buf);')
+            out.append('};')
+        else:
+            out.append('/**')
+            out.append(' * Decode a packed %s byte array; null if it is too short' % name)
+            out.append(' */')
+            out.append('Protocol.decode%s = function(bytes) {' % name)
+            out.append('    if (!bytes || bytes.length < %d) return null;' % size)
+            out.append('    var view = new DataView(new Uint8Array(bytes).buffer);')
+            out.append('    return {')
+            entries = []
+            for f in layout['fields']:
+                width = TYPES[f['type']][0]
+                suffix = TYPES[f['type']][3]
+                endian = ', true' if width > 1 else ''
+                if 'count' in f:
+                    items = ['view.get%s(%d%s)' % (suffix, f['offset'] + i * width, endian)
+                             for i in range(f['count'])]
+                    entries.append('        %s: [%s]' % (f['name'], ', '.join(items)))
+                else:
+                    entries.append('        %s: view.get%s(%d%s)' % (f['name'], suffix, f['offset'], endian))
+            out.append(',\n'.join(entries))
+            out.append('    };')
+            out.append('};')
+        out.append('')
+
+    out.append('module.exports = Protocol;')
+    out.append('')
+    return '\n'.join(out)
+
+
+# --- package.json -------------------------------------------------------------
+
+def gen_package(root, schema):
+    with io.open(os.path.join(root, PACKAGE), encoding='utf-8') as f:
+        package = json.load(f, object_pairs_hook=OrderedDict)
+    package['pebble']['messageKeys'] = [k['name'] for k in schema['keys']]
+    return json.dumps(package, indent=2, separators=(',', ': ')) + '\n'
+
+
+def generate(root, check=False):
+    """Regenerate the outputs under root; returns the list of stale files."""
+    schema = load_schema(root)
+    outputs = [
+        (C_OUT, gen_c(schema)),
+        (JS_OUT, gen_js(schema)),
+        (PACKAGE, gen_package(root, schema)),
+    ]
+    stale = []
+    for path, text in outputs:
+        full = os.path.join(root, path)
+        current = None
+        if os.path.exists(full):
+            with io.open(full, encoding='utf-8') as f:
+                current = f.read()
+        if current == text:
+            continue
+        stale.append(path)
+        if not check:
+            with io.open(full, 'w', encoding='utf-8') as f:
+                f.write(text if isinstance(text, type(u'')) else text.decode('utf-8'))
+    return stale
+
+
+if __name__ == '__main__':
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    check = '--check' in sys.argv[1:]
+    stale = generate(root, check)
+    for path in stale:
+        print(('stale: ' if check else 'wrote: ') + path)
+    sys.exit(1 if check and stale else 0)